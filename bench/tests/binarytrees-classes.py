@@ -0,0 +1,74 @@
+# args: 6
+# output: stretch tree of depth 7	 check: -1
+# output: 128	 trees of depth 4	 check: -128
+# output: 32	 trees of depth 6	 check: -32
+# output: long lived tree of depth 6	 check: -1
+# bench-args: 11
+
+# Version of binarytrees.py that represents tree nodes as instances of a class
+# rather than as tuples.
+
+import sys
+
+class Node:
+    def __init__(self, item, left, right):
+        self.item = item
+        self.left = left
+        self.right = right
+
+    def check(self):
+        if self.left is None:
+            return self.item
+        return self.item + self.left.check() - self.right.check()
+
+
+def make_tree(i, d):
+
+    if d > 0:
+        d -= 1
+        return Node(i, make_tree(i, d), make_tree(i + 1, d))
+    return Node(i, None, None)
+
+
+def make_check(itde):
+
+    i, d = itde
+    return make_tree(i, d).check()
+
+
+def get_argchunks(i, d, chunksize=5000):
+
+    assert chunksize % 2 == 0
+    chunk = []
+    for k in range(1, i + 1):
+        chunk.extend([(k, d), (-k, d)])
+        if len(chunk) == chunksize:
+            yield chunk
+            chunk = []
+    if len(chunk) > 0:
+        yield chunk
+
+
+def main(n, min_depth=4):
+
+    max_depth = max(min_depth + 2, n)
+    stretch_depth = max_depth + 1
+
+    print('stretch tree of depth ' + str(stretch_depth) +
+          '\t check: ' + str(make_check((0, stretch_depth))))
+
+    long_lived_tree = make_tree(0, max_depth)
+
+    mmd = max_depth + min_depth
+    for d in range(min_depth, stretch_depth, 2):
+        i = 2 ** (mmd - d)
+        cs = 0
+        for argchunk in get_argchunks(i,d):
+            cs += sum(map(make_check, argchunk))
+        print(str(i * 2) + '\t trees of depth ' + str(d) +
+              '\t check: ' + str(cs))
+
+    print('long lived tree of depth ' + str(max_depth) + '\t check: ' + str(long_lived_tree.check()))
+
+if __name__ == '__main__':
+    main(int(sys.argv[1]))
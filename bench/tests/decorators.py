@@ -0,0 +1,48 @@
+# args: 10
+# output: 415
+# bench-args: 200000
+# bench-output: 179999300000
+
+# Calls through layers of decorators that forward their arguments to the
+# wrapped function.
+
+import sys
+
+def counted(f):
+    def wrapper(*args, **kwargs):
+        wrapper.calls += 1
+        return f(*args, **kwargs)
+    wrapper.calls = 0
+    return wrapper
+
+def logged(f):
+    def wrapper(*args, **kwargs):
+        return f(*args, **kwargs)
+    return wrapper
+
+def positional(f):
+    def wrapper(*args):
+        return f(*args)
+    return wrapper
+
+@counted
+@logged
+def add(*args, **kwargs):
+    total = 0
+    for a in args:
+        total += a
+    return total
+
+@positional
+@counted
+def mul(*args):
+    return args[0] * args[1]
+
+def main(n):
+    total = 0
+    for i in range(n):
+        total += add(i, i, 1)
+        total += mul(i, 7)
+    return total
+
+print(main(int(sys.argv[1])))
@@ -0,0 +1,57 @@
+# args: 100
+# output: 6150
+# bench-args: 200000
+# bench-output: 20002300000
+
+# Dict insertion, lookup hits and misses, deletion and iteration with int and
+# string keys.
+
+import sys
+
+def run(keys):
+    d = {}
+    for k in keys:
+        d[k] = 1
+
+    hits = 0
+    for k in keys:
+        hits += d[k]
+
+    misses = 0
+    for k in keys:
+        if k in d:
+            hits += 1
+        else:
+            misses += 1
+
+    for i in range(0, len(keys), 2):
+        del d[keys[i]]
+
+    for k in keys:
+        d[k] = 2
+
+    total = 0
+    for k in d:
+        total += d[k]
+    for v in d.values():
+        total += v
+    return hits + misses + total
+
+def main(n):
+    ints = list(range(n))
+    strs = [str(i) for i in ints]
+    total = 0
+    total += run(ints)
+    total += run(strs)
+    missing = [i + n for i in ints]
+    d = {}
+    for i in ints:
+        d[i] = i
+    for k in missing:
+        if k in d:
+            total += 1
+    for k in d:
+        total += d[k]
+    return total
+
+print(main(int(sys.argv[1])))
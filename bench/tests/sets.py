@@ -0,0 +1,30 @@
+# args: 100
+# output: 2000
+# bench-args: 100000
+# bench-output: 1505000
+
+# Deduplication, membership tests and set algebra.
+
+import sys
+
+def main(n):
+    values = [i % (n // 2) for i in range(n)]
+    words = [str(i % 1000) for i in range(n)]
+    total = 0
+    for i in range(5):
+        unique = set(values)
+        total += len(unique)
+        hits = 0
+        for v in values:
+            if v in unique:
+                hits += 1
+        total += hits
+        evens = set(range(0, n, 2))
+        odds = set(range(1, n, 2))
+        total += len(evens | odds) + len(unique & evens) + len(unique - odds)
+        total += len(set(words))
+        if not (evens <= unique | evens) or evens == odds:
+            total += 1
+    return total
+
+print(main(int(sys.argv[1])))
@@ -0,0 +1,33 @@
+# args: 100
+# output: 4370
+# bench-args: 20000
+# bench-output: 924890
+
+# Tokenize a large text by repeatedly slicing off the front of it.
+
+import sys
+
+def makeText(n):
+    lines = []
+    for i in range(n):
+        lines.append("2024-01-01 12:00:00 INFO request " + str(i) +
+                     " handled in " + str(i % 50) + "ms by worker-" +
+                     str(i % 8))
+    return "\n".join(lines)
+
+def main(n):
+    rest = makeText(n)
+    total = 0
+    count = 0
+    while len(rest):
+        end = rest.find("\n")
+        if end == -1:
+            end = len(rest)
+        line = rest[:end]
+        total += len(line[20:])
+        if line[20:24] == "INFO":
+            count += 1
+        rest = rest[end + 1:]
+    return total + count
+
+print(main(int(sys.argv[1])))
@@ -0,0 +1,38 @@
+# args: 100
+# output: 1026
+# bench-args: 200000
+# bench-output: 4285885711
+
+# Sort lists of ints, floats and strings, with and without a key function.
+
+import sys
+
+def checksum(a):
+    total = 0
+    n = len(a)
+    for i in range(0, n, 7):
+        if a[i] < a[n - 1 - i]:
+            total += i
+        elif a[i] > a[n - 1 - i]:
+            total += 2 * i
+    return total
+
+def main(n):
+    ints = [(i * 7919) % n for i in range(n)]
+    floats = [x * 0.5 for x in ints]
+    strs = [str(x) for x in ints]
+
+    total = 0
+    for a in (ints, floats, strs):
+        b = sorted(a)
+        c = sorted(a, reverse = True)
+        total += checksum(b) - checksum(c)
+        a.sort()
+        total += checksum(a) - checksum(b)
+
+    words = [str(i * i % 100003) for i in range(n)]
+    byLength = sorted(words, key = len)
+    total += len(byLength[0]) - len(byLength[n - 1])
+    return total
+
+print(main(int(sys.argv[1])))
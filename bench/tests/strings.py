@@ -0,0 +1,26 @@
+# args: 100
+# output: 2078
+# bench-args: 200000
+# bench-output: 5577778
+
+# Build a report by repeated string appending and by joining lines.
+
+import sys
+
+def report(n):
+    out = ""
+    for i in range(n):
+        out += "line " + str(i) + ": "
+        out += "ok\n"
+    return out
+
+def joined(n):
+    lines = []
+    for i in range(n):
+        lines.append("item " + str(i))
+    return ", ".join(lines)
+
+def main(n):
+    return len(report(n)) + len(joined(n))
+
+print(main(int(sys.argv[1])))
@@ -0,0 +1,37 @@
+# args: 100
+# output: 17160
+# bench-args: 100000
+# bench-output: 17663050
+
+# Text processing on a large string: searching, counting, splitting,
+# replacing and per-line transformations.
+
+import sys
+
+words = ["alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"]
+
+def makeText(n):
+    lines = []
+    for i in range(n):
+        w = words[i % len(words)]
+        lines.append("  " + w + " record " + str(i) + " value=" + str(i * 7) +
+                     " status=" + ("ERROR" if i % 97 == 0 else "ok") + "  ")
+    return "\n".join(lines)
+
+def main(n):
+    text = makeText(n)
+    total = len(text)
+    total += text.count("ERROR")
+    total += text.count("record")
+    total += text.find("status=ERROR", len(text) // 2)
+    total += len(text.replace("record", "rec"))
+    total += len(text.upper())
+    total += 1 if "missing needle" in text else 0
+    for line in text.split("\n"):
+        line = line.strip()
+        if line.startswith("gamma") or line.endswith("ERROR"):
+            total += len(line.split())
+        total += line.index("value=")
+    return total
+
+print(main(int(sys.argv[1])))
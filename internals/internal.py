@@ -37,27 +37,12 @@ def dictEqual(a, b):
 def dictNotEqual(a, b):
     return not dictEqual(a, b)
 
-def setEqual(a, b):
-    if not isinstance(b, set):
-        return False
-    if len(a) != len(b):
-        return False
-    for key in a.keys():
-        if key not in b:
-            return False
-    return True
-
-def setNotEqual(a, b):
-    return not setEqual(a, b)
-
 list.__eq__ = listEqual
 list.__ne__ = listNotEqual
 tuple.__eq__ = tupleEqual
 tuple.__ne__ = tupleNotEqual
 dict.__eq__ = dictEqual
 dict.__ne__ = dictNotEqual
-set.__eq__ = setEqual
-set.__ne__ = setNotEqual
 
 def listExtend(a, b):
     for element in b:
@@ -65,23 +50,20 @@ def listExtend(a, b):
 
 list.extend = listExtend
 
-def strJoin(self, seq):
-    if not isinstance(self, str):
-        raise TypeError("Expecting string")
+# Native functions don't take keyword arguments, so wrap the ones that need
+# them.  The wrapped version of sorted replaces the builtin.
 
-    result = ""
-    first = True
-    for s in seq:
-        if not isinstance(s, str):
-            raise TypeError("Expecting string")
-        if not first:
-            result += self
-        result += s
-        first = False
+listSortNative = list.sort
 
-    return result
+def listSort(self, key = None, reverse = False):
+    return listSortNative(self, key, reverse)
+
+list.sort = listSort
+
+sortedNative = sorted
 
-str.join = strJoin
+def sorted(iterable, key = None, reverse = False):
+    return sortedNative(iterable, key, reverse)
 
 class SequenceIterator:
     def __init__(self, target):
@@ -94,7 +76,8 @@ class SequenceIterator:
             self.index += 1
             return result
         except IndexError:
-            raise StopIteration()
+            # Raise the shared instance, which doesn't record a traceback.
+            raise stopIteration
 
 def iterableToList(iterable):
     result = []
@@ -1,4 +1,5 @@
 #include "analysis.h"
+#include "frame.h"
 #include "numeric.h"
 #include "object.h"
 #include "parser.h"
@@ -9,8 +10,7 @@ struct DefinitionFinder : public DefaultSyntaxVisitor
 {
     DefinitionFinder(Traced<Layout*> layout, vector<Name>& globalsOut)
       : inAssignTarget_(false),
-        globals_(globalsOut),
-        hasNestedFuctions_(false)
+        globals_(globalsOut)
     {
         defs_ = gc.create<Object>(Object::ObjectClass, layout);
     }
@@ -19,7 +19,6 @@ struct DefinitionFinder : public DefaultSyntaxVisitor
         assert(!inAssignTarget_);
     }
 
-    bool hasNestedFuctions() { return hasNestedFuctions_; }
     Object* definitions() { return defs_; }
 
     void addName(Name name) {
@@ -56,11 +55,6 @@ struct DefinitionFinder : public DefaultSyntaxVisitor
 
     virtual void visit(const SyntaxDef& s) {
         addName(s.id);
-        hasNestedFuctions_ = true;
-    }
-
-    virtual void visit(const SyntaxLambda& s) {
-        hasNestedFuctions_ = true;
     }
 
     virtual void visit(const SyntaxClass& s) {
@@ -218,10 +212,6 @@ struct DefinitionFinder : public DefaultSyntaxVisitor
             s.finallySuite->accept(*this);
     }
 
-    virtual void visit(const SyntaxListComp& s) {
-        hasNestedFuctions_ = true;
-    }
-
     virtual void visit(const SyntaxCompIterand& s) {
         s.expr->accept(*this);
     }
@@ -236,16 +226,259 @@ struct DefinitionFinder : public DefaultSyntaxVisitor
     Root<Object*> defs_;
     vector<Name>& globals_;
     vector<Name> nonLocals_;
-    bool hasNestedFuctions_;
+};
+
+// Find the names referenced in a block that may be resolved in an enclosing
+// scope.  This visits the whole block, including the bodies of nested scopes,
+// and may over-approximate but must never miss a name that a nested scope looks
+// up lexically.
+struct ReferenceFinder : public DefaultSyntaxVisitor
+{
+    ReferenceFinder(vector<Name>& namesOut, bool includeOwnNames)
+      : names_(namesOut),
+        includeOwnNames_(includeOwnNames)
+    {}
+
+    void addName(Name name) {
+        if (!contains(names_, name))
+            names_.push_back(name);
+    }
+
+    void maybeVisit(const unique_ptr<Syntax>& s) {
+        if (s)
+            s->accept(*this);
+    }
+
+    // Add the names referenced by a nested scope that are not defined there.
+    void addFreeNames(const Syntax& s, Traced<Layout*> layout) {
+        vector<Name> globals;
+        DefinitionFinder finder(layout, globals);
+        s.accept(finder);
+        Stack<Layout*> defined(finder.definitions()->layout());
+
+        vector<Name> refs;
+        ReferenceFinder refFinder(refs, true);
+        s.accept(refFinder);
+        for (auto name : refs) {
+            if (!defined->hasName(name))
+                addName(name);
+        }
+    }
+
+    void addFreeNames(const Syntax& s, const vector<Parameter>& params) {
+        Stack<Layout*> layout(Env::InitialLayout);
+        for (const auto& param : params)
+            layout = layout->addName(param.name);
+        addFreeNames(s, layout);
+    }
+
+    void addFreeNames(const Syntax& s, Name name) {
+        Stack<Layout*> layout(Env::InitialLayout);
+        layout = layout->addName(name);
+        addFreeNames(s, layout);
+    }
+
+    // Nested scopes
+
+    virtual void visit(const SyntaxLambda& s) {
+        for (const auto& param : s.params)
+            maybeVisit(param.maybeDefault);
+        addFreeNames(*s.expr, s.params);
+    }
+
+    virtual void visit(const SyntaxDef& s) {
+        for (const auto& d : s.decorators)
+            d->accept(*this);
+        for (const auto& param : s.params)
+            maybeVisit(param.maybeDefault);
+        addFreeNames(*s.suite, s.params);
+    }
+
+    virtual void visit(const SyntaxClass& s) {
+        for (const auto& d : s.decorators)
+            d->accept(*this);
+        if (s.bases)
+            s.bases->accept(*this);
+        addFreeNames(*s.suite, Names::__bases__);
+    }
+
+    virtual void visit(const SyntaxListComp& s) {
+        addFreeNames(*s.expr, Names::listCompResult);
+    }
+
+    // Record references
+
+    virtual void visit(const SyntaxName& s) {
+        if (includeOwnNames_)
+            addName(s.id);
+    }
+
+    virtual void visit(const SyntaxNonLocal& s) {
+        if (includeOwnNames_) {
+            for (auto name : s.names)
+                addName(name);
+        }
+    }
+
+    // Recurse into statements and expressions
+
+    virtual void visit(const SyntaxBlock& s) {
+        for (const auto& i : s.statements)
+            i->accept(*this);
+    }
+
+    virtual void visit(const SyntaxExprList& s) {
+        for (const auto& i : s.elements)
+            i->accept(*this);
+    }
+
+    virtual void visit(const SyntaxList& s) {
+        for (const auto& i : s.elements)
+            i->accept(*this);
+    }
+
+    virtual void visit(const SyntaxDict& s) {
+        for (const auto& i : s.entries) {
+            i.first->accept(*this);
+            i.second->accept(*this);
+        }
+    }
+
+    virtual void visit(const SyntaxSet& s) {
+        for (const auto& i : s.elements)
+            i->accept(*this);
+    }
+
+    virtual void visit(const SyntaxPos& s) { s.right->accept(*this); }
+    virtual void visit(const SyntaxNeg& s) { s.right->accept(*this); }
+    virtual void visit(const SyntaxInvert& s) { s.right->accept(*this); }
+    virtual void visit(const SyntaxNot& s) { s.right->accept(*this); }
+    virtual void visit(const SyntaxReturn& s) { maybeVisit(s.right); }
+    virtual void visit(const SyntaxRaise& s) { maybeVisit(s.right); }
+    virtual void visit(const SyntaxYield& s) { maybeVisit(s.right); }
+
+    template <typename BaseT, typename LeftT, typename RightT>
+    void visitBinary(const BinarySyntax<BaseT, LeftT, RightT>& s) {
+        s.left->accept(*this);
+        s.right->accept(*this);
+    }
+
+    virtual void visit(const SyntaxOr& s) { visitBinary(s); }
+    virtual void visit(const SyntaxAnd& s) { visitBinary(s); }
+    virtual void visit(const SyntaxIn& s) { visitBinary(s); }
+    virtual void visit(const SyntaxIs& s) { visitBinary(s); }
+    virtual void visit(const SyntaxCompareOp& s) { visitBinary(s); }
+    virtual void visit(const SyntaxBinaryOp& s) { visitBinary(s); }
+    virtual void visit(const SyntaxAugAssign& s) { visitBinary(s); }
+    virtual void visit(const SyntaxAssign& s) { visitBinary(s); }
+    virtual void visit(const SyntaxSubscript& s) { visitBinary(s); }
+
+    virtual void visit(const SyntaxAttrRef& s) {
+        s.left->accept(*this);
+    }
+
+    virtual void visit(const SyntaxTargetList& s) {
+        for (const auto& i : s.targets)
+            i->accept(*this);
+    }
+
+    virtual void visit(const SyntaxCall& s) {
+        s.target->accept(*this);
+        for (const auto& i : s.positionalArgs)
+            i->arg->accept(*this);
+        for (const auto& i : s.keywordArgs)
+            i->arg->accept(*this);
+        maybeVisit(s.mappingArg);
+    }
+
+    virtual void visit(const SyntaxCond& s) {
+        s.cons->accept(*this);
+        s.cond->accept(*this);
+        s.alt->accept(*this);
+    }
+
+    virtual void visit(const SyntaxIf& s) {
+        for (const auto& i : s.branches) {
+            i.cond->accept(*this);
+            i.suite->accept(*this);
+        }
+        if (s.elseSuite)
+            s.elseSuite->accept(*this);
+    }
+
+    virtual void visit(const SyntaxWhile& s) {
+        s.cond->accept(*this);
+        s.suite->accept(*this);
+        if (s.elseSuite)
+            s.elseSuite->accept(*this);
+    }
+
+    virtual void visit(const SyntaxSlice& s) {
+        maybeVisit(s.lower);
+        maybeVisit(s.upper);
+        maybeVisit(s.stride);
+    }
+
+    virtual void visit(const SyntaxAssert& s) {
+        s.cond->accept(*this);
+        maybeVisit(s.message);
+    }
+
+    virtual void visit(const SyntaxFor& s) {
+        s.targets->accept(*this);
+        s.exprs->accept(*this);
+        s.suite->accept(*this);
+        maybeVisit(s.elseSuite);
+    }
+
+    virtual void visit(const SyntaxTry& s) {
+        s.trySuite->accept(*this);
+        for (const auto& except : s.excepts) {
+            maybeVisit(except->expr);
+            if (except->as)
+                except->as->accept(*this);
+            except->suite->accept(*this);
+        }
+        if (s.elseSuite)
+            s.elseSuite->accept(*this);
+        if (s.finallySuite)
+            s.finallySuite->accept(*this);
+    }
+
+    virtual void visit(const SyntaxDel& s) {
+        s.targets->accept(*this);
+    }
+
+    virtual void visit(const SyntaxCompIterand& s) {
+        s.expr->accept(*this);
+    }
+
+    virtual void visit(const SyntaxDecorator& s) {
+        s.expr->accept(*this);
+    }
+
+  private:
+    vector<Name>& names_;
+    bool includeOwnNames_;
 };
 
 Object* FindDefinitions(const Syntax& s,
                         Traced<Layout*> layout,
                         vector<Name>& globalsOut,
-                        bool& hasNestedFuctionsOut)
+                        vector<Name>& capturedOut)
 {
     DefinitionFinder finder(layout, globalsOut);
     s.accept(finder);
-    hasNestedFuctionsOut = finder.hasNestedFuctions();
-    return finder.definitions();
+    Stack<Object*> defs(finder.definitions());
+
+    vector<Name> nestedRefs;
+    ReferenceFinder refFinder(nestedRefs, false);
+    s.accept(refFinder);
+    Stack<Layout*> defined(defs->layout());
+    for (auto name : nestedRefs) {
+        if (defined->hasName(name))
+            capturedOut.push_back(name);
+    }
+
+    return defs;
 }
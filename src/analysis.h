@@ -5,9 +5,12 @@
 #include "name.h"
 #include "syntax.h"
 
+// Find the names defined in a block.  Also returns any names declared global,
+// and the defined names that are referenced by nested scopes and so must be
+// stored in the block's environment rather than on the stack.
 extern Object* FindDefinitions(const Syntax& s,
                                Traced<Layout*> layout,
                                vector<Name>& globalsOut,
-                               bool& hasNestedFuctionsOut);
+                               vector<Name>& capturedOut);
 
 #endif
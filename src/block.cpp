@@ -7,19 +7,23 @@ Block::Block(Traced<Block*> parent,
              Traced<Env*> global,
              Traced<Layout*> layout,
              unsigned argCount,
-             bool createEnv)
+             bool localsInEnv,
+             Traced<Layout*> capturedLayout)
   : parent_(parent),
     global_(global),
     layout_(layout),
     argCount_(argCount),
     maxStackDepth_(0),
-    createEnv_(createEnv)
-{}
+    localsInEnv_(localsInEnv),
+    capturedLayout_(capturedLayout)
+{
+    assert(!localsInEnv || !capturedLayout);
+}
 
 unsigned Block::stackLocalCount() const
 {
     assert(layout()->slotCount() >= argCount());
-    return createEnv() ? 0 : layout()->slotCount() - argCount();
+    return localsInEnv() ? 0 : layout()->slotCount() - argCount();
 }
 
 void Block::setMaxStackDepth(unsigned stackDepth)
@@ -56,6 +60,48 @@ void Block::branchHere(unsigned source)
     b->setOffset(offsetFrom(source));
 }
 
+unsigned Block::addExceptionHandler(ExceptionHandler::Type type,
+                                    unsigned stackDepth)
+{
+    unsigned index = exceptionHandlers_.size();
+    exceptionHandlers_.emplace_back(type, nextIndex(), stackDepth);
+    return index;
+}
+
+void Block::setExceptionHandlerEnd(unsigned index)
+{
+    ExceptionHandler& handler = exceptionHandlers_.at(index);
+    assert(handler.end == handler.start);
+    assert(nextIndex() > handler.start);
+    handler.end = nextIndex();
+}
+
+void Block::setExceptionHandlerTarget(unsigned index)
+{
+    ExceptionHandler& handler = exceptionHandlers_.at(index);
+    assert(handler.end > handler.start);
+    assert(nextIndex() >= handler.end);
+    handler.target = nextIndex();
+}
+
+const ExceptionHandler* Block::findExceptionHandler(unsigned offset,
+                                                    bool finallyOnly) const
+{
+    // Handlers are added in the order their ranges start, so nested handlers
+    // always follow the handlers that enclose them.
+    for (auto i = exceptionHandlers_.rbegin();
+         i != exceptionHandlers_.rend();
+         ++i)
+    {
+        if (i->contains(offset) &&
+            (!finallyOnly || i->type == ExceptionHandler::FinallyHandler))
+        {
+            return &(*i);
+        }
+    }
+    return nullptr;
+}
+
 void Block::print(ostream& s) const {
     for (auto i = instrs_.begin(); i != instrs_.end(); ++i) {
         if (i != instrs_.begin())
@@ -69,6 +115,7 @@ void Block::traceChildren(Tracer& t)
     gc.trace(t, &parent_);
     gc.trace(t, &global_);
     gc.trace(t, &layout_);
+    gc.trace(t, &capturedLayout_);
     for (auto i = instrs_.begin(); i != instrs_.end(); ++i)
         gc.trace(t, &i->data);
 }
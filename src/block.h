@@ -17,13 +17,38 @@ struct Layout;
 struct Object;
 struct Syntax;
 
+// An entry in a block's exception handler table.  Exceptions raised by the
+// instructions in [start, end) are handled by jumping to target with the stack
+// reset to stackDepth values above the frame's stack position.
+struct ExceptionHandler
+{
+    enum Type {
+        CatchHandler, FinallyHandler
+    };
+
+    ExceptionHandler(Type type, unsigned start, unsigned stackDepth)
+      : type(type), start(start), end(start), target(0), stackDepth(stackDepth)
+    {}
+
+    bool contains(unsigned offset) const {
+        return offset >= start && offset < end;
+    }
+
+    Type type;
+    unsigned start;
+    unsigned end;
+    unsigned target;
+    unsigned stackDepth;
+};
+
 struct Block : public Cell
 {
     Block(Traced<Block*> parent,
           Traced<Env*> global,
           Traced<Layout*> layout,
           unsigned argCount,
-          bool createEnv);
+          bool localsInEnv,
+          Traced<Layout*> capturedLayout = nullptr);
 
     Block* parent() const { return parent_; }
     Env* global() const { return global_; }
@@ -31,7 +56,15 @@ struct Block : public Cell
     unsigned argCount() const { return argCount_; }
     unsigned stackLocalCount() const;
     unsigned maxStackDepth() const { return maxStackDepth_; }
-    bool createEnv() const { return createEnv_; }
+
+    // Whether all locals are stored in an environment created for each call.
+    // Otherwise locals are stored on the stack, and an environment is created
+    // only if some are captured by nested scopes, to hold just those.
+    bool localsInEnv() const { return localsInEnv_; }
+    bool createEnv() const { return localsInEnv_ || capturedLayout_; }
+    Layout* envLayout() const {
+        return localsInEnv_ ? layout_ : capturedLayout_;
+    }
     InstrThunk* startInstr() { return &instrs_[0]; }
     unsigned instrCount() { return instrs_.size(); }
     InstrThunk instr(unsigned i) { return instrs_.at(i); }
@@ -46,6 +79,22 @@ struct Block : public Cell
     template <InstrCode Code, typename... Args>
     inline unsigned append(Args&& ...args);
 
+    // Add a handler covering instructions from the next index onwards and
+    // return its index.  The compiler sets the end of the covered range and
+    // the handler's target as it reaches them.
+    unsigned addExceptionHandler(ExceptionHandler::Type type,
+                                 unsigned stackDepth);
+    const ExceptionHandler& exceptionHandler(unsigned index) const {
+        return exceptionHandlers_.at(index);
+    }
+    void setExceptionHandlerEnd(unsigned index);
+    void setExceptionHandlerTarget(unsigned index);
+
+    // Find the innermost handler covering the instruction at |offset|,
+    // optionally considering only finally handlers.
+    const ExceptionHandler* findExceptionHandler(unsigned offset,
+                                                 bool finallyOnly = false) const;
+
     unsigned append(Traced<Instr*> data);
 
     const InstrThunk& lastInstr() {
@@ -72,8 +121,10 @@ struct Block : public Cell
     Heap<Layout*> layout_;
     unsigned argCount_;
     unsigned maxStackDepth_;
-    bool createEnv_;
+    bool localsInEnv_;
+    Heap<Layout*> capturedLayout_;
     vector<InstrThunk> instrs_;
+    vector<ExceptionHandler> exceptionHandlers_;
     string file_;
     vector<pair<size_t, unsigned>> offsetLines_;
 };
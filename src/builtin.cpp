@@ -7,10 +7,12 @@
 #include "file.h"
 #include "input.h"
 #include "interp.h"
+#include "iterator.h"
 #include "numeric.h"
 #include "list.h"
 #include "module.h"
 #include "parser.h"
+#include "range.h"
 #include "reflect.h"
 #include "singletons.h"
 #include "set.h"
@@ -81,6 +83,347 @@ static bool builtin_compile(NativeArgs args,
     return CompileModule(source, globals, resultOut);
 }
 
+static bool CallMethodAttr(Traced<Value> self, StackMethodAttr& method,
+                           MutableTraced<Value> resultOut)
+{
+    if (method.isCallable)
+        return interp->call(method.method, self, resultOut);
+    return interp->call(method.method, resultOut);
+}
+
+static bool CallMethodAttr(Traced<Value> self, StackMethodAttr& method,
+                           Traced<Value> arg, MutableTraced<Value> resultOut)
+{
+    if (method.isCallable)
+        return interp->call(method.method, self, arg, resultOut);
+    return interp->call(method.method, arg, resultOut);
+}
+
+// Call |func| on each element of |iterable|, reading builtin sequences directly
+// and otherwise using the iteration protocol.  Stops if |func| returns false.
+template <typename F>
+static bool ForEachElement(Traced<Value> iterable, MutableTraced<Value> resultOut,
+                           F&& func)
+{
+    Stack<Value> element;
+    if (iterable.is<List>()) {
+        Stack<List*> list(iterable.as<List>());
+        for (int32_t i = 0; i < list->len(); i++) {
+            element = list->getitem(i);
+            if (!func(element, resultOut))
+                return false;
+        }
+        return true;
+    }
+
+    if (iterable.is<Tuple>()) {
+        Stack<Tuple*> tuple(iterable.as<Tuple>());
+        for (int32_t i = 0; i < tuple->len(); i++) {
+            element = tuple->getitem(i);
+            if (!func(element, resultOut))
+                return false;
+        }
+        return true;
+    }
+
+    if (iterable.is<Range>() && iterable.as<Range>()->isInt32()) {
+        Range* range = iterable.as<Range>();
+        int32_t current = range->start().asInt32();
+        int32_t stop = range->stop().asInt32();
+        int32_t step = range->step().asInt32();
+        int32_t value;
+        while (Range::next(current, stop, step, value)) {
+            element = Value(value);
+            if (!func(element, resultOut))
+                return false;
+        }
+        return true;
+    }
+
+    Stack<Value> iterator;
+    if (!GetIterator(iterable, iterator)) {
+        resultOut = iterator;
+        return false;
+    }
+
+    for (;;) {
+        if (!IteratorNext(iterator, element)) {
+            if (element.is<StopIteration>())
+                return true;
+            resultOut = element;
+            return false;
+        }
+        if (!func(element, resultOut))
+            return false;
+    }
+}
+
+template <CompareOp Op>
+bool CompareValues(Traced<Value> left, Traced<Value> right,
+                   bool& resultOut, MutableTraced<Value> errorOut)
+{
+    if (left.isInt32() && right.isInt32()) {
+        Value result = Integer::compareOp<Op>(left.asInt32(), right.asInt32());
+        resultOut = result == Value(Boolean::True);
+        return true;
+    }
+
+    if (left.isDouble() && right.isDouble()) {
+        Value result = Float::compareOp<Op>(left.asDouble(), right.asDouble());
+        resultOut = result == Value(Boolean::True);
+        return true;
+    }
+
+    Stack<Value> result;
+    StackMethodAttr method;
+    if (getSpecialMethodAttr(left, Names::compareMethod[Op], method)) {
+        if (!CallMethodAttr(left, method, right, result)) {
+            errorOut = result;
+            return false;
+        }
+        if (result != Value(NotImplemented)) {
+            resultOut = Value::IsTrue(result);
+            return true;
+        }
+    }
+
+    if (getSpecialMethodAttr(right, Names::compareMethodReflected[Op], method)) {
+        if (!CallMethodAttr(right, method, left, result)) {
+            errorOut = result;
+            return false;
+        }
+        if (result != Value(NotImplemented)) {
+            resultOut = Value::IsTrue(result);
+            return true;
+        }
+    }
+
+    return Raise<TypeError>(
+        "unsupported operand type(s) for compare operation", errorOut);
+}
+
+template bool CompareValues<CompareLT>(Traced<Value> left, Traced<Value> right,
+                                       bool& resultOut,
+                                       MutableTraced<Value> errorOut);
+
+template <BinaryOp Op>
+static bool BinaryOpValues(Traced<Value> left, Traced<Value> right,
+                           MutableTraced<Value> resultOut)
+{
+    if (left.isInt32() && right.isInt32())
+        return Integer::binaryOp<Op>(left.asInt32(), right.asInt32(), resultOut);
+
+    if (left.isDouble() && right.isDouble()) {
+        resultOut = Float::binaryOp<Op>(left.asDouble(), right.asDouble());
+        return true;
+    }
+
+    StackMethodAttr method;
+    if (getSpecialMethodAttr(left, Names::binMethod[Op], method)) {
+        if (!CallMethodAttr(left, method, right, resultOut))
+            return false;
+        if (resultOut != Value(NotImplemented))
+            return true;
+    }
+
+    if (getSpecialMethodAttr(right, Names::binMethodReflected[Op], method)) {
+        if (!CallMethodAttr(right, method, left, resultOut))
+            return false;
+        if (resultOut != Value(NotImplemented))
+            return true;
+    }
+
+    return Raise<TypeError>(
+        "unsupported operand type(s) for binary operation", resultOut);
+}
+
+static bool builtin_len(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Value> value(args[0]);
+    if (value.is<List>()) {
+        resultOut = Integer::get(value.as<List>()->len());
+        return true;
+    } else if (value.is<Tuple>()) {
+        resultOut = Integer::get(value.as<Tuple>()->len());
+        return true;
+    } else if (value.is<String>()) {
+        resultOut = Integer::get(value.as<String>()->size());
+        return true;
+    } else if (value.is<Dict>()) {
+        resultOut = Integer::get(value.as<Dict>()->len());
+        return true;
+    } else if (value.is<Set>()) {
+        resultOut = Integer::get(value.as<Set>()->len());
+        return true;
+    } else if (value.is<Range>()) {
+        resultOut = value.as<Range>()->len();
+        return true;
+    }
+
+    StackMethodAttr method;
+    if (!getSpecialMethodAttr(value, Names::__len__, method)) {
+        string message = "object of type '" + value.type()->name() +
+                         "' has no len()";
+        return Raise<TypeError>(message, resultOut);
+    }
+
+    return CallMethodAttr(value, method, resultOut);
+}
+
+static bool builtin_repr(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Value> value(args[0]);
+    StackMethodAttr method;
+    if (!getSpecialMethodAttr(value, Names::__repr__, method))
+        return Raise<TypeError>("Object has no __repr__ method", resultOut);
+
+    return CallMethodAttr(value, method, resultOut);
+}
+
+static bool builtin_print(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    string output;
+    Stack<Value> str;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (i != 0)
+            output += " ";
+        if (!valueToString(args[i], str)) {
+            resultOut = str;
+            return false;
+        }
+        String* s = str.as<String>();
+        output.append(s->data(), s->size());
+    }
+
+    cout << output << endl;
+    resultOut = None;
+    return true;
+}
+
+static bool builtin_type(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    resultOut = args[0].type();
+    return true;
+}
+
+template <CompareOp Op>
+static bool builtin_minmax(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    // With a single argument, return the extreme element of an iterable,
+    // otherwise of the arguments themselves.
+    Stack<Value> iterable;
+    if (args.size() == 1) {
+        iterable = args[0];
+    } else {
+        Stack<Tuple*> tuple(Tuple::get(args));
+        iterable = tuple;
+    }
+
+    Stack<Value> best;
+    bool found = false;
+    bool ok = ForEachElement(iterable, resultOut,
+                             [&] (Traced<Value> element,
+                                  MutableTraced<Value> errorOut) {
+        bool replace = true;
+        if (found && !CompareValues<Op>(element, best, replace, errorOut))
+            return false;
+        if (replace)
+            best = element;
+        found = true;
+        return true;
+    });
+    if (!ok)
+        return false;
+
+    if (!found) {
+        const char* message = Op == CompareGT ? "max() arg is an empty sequence"
+                                              : "min() arg is an empty sequence";
+        return Raise<ValueError>(message, resultOut);
+    }
+
+    resultOut = best;
+    return true;
+}
+
+static bool builtin_sum(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Value> total(args.size() == 2 ? args[1] : Value(0));
+    bool ok = ForEachElement(args[0], resultOut,
+                             [&] (Traced<Value> element,
+                                  MutableTraced<Value> errorOut) {
+        if (!BinaryOpValues<BinaryAdd>(total, element, errorOut))
+            return false;
+        total = errorOut;
+        return true;
+    });
+    if (!ok)
+        return false;
+
+    resultOut = total;
+    return true;
+}
+
+static bool builtin_divmod(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Value> a(args[0]);
+    Stack<Value> b(args[1]);
+    Stack<Value> quotient;
+    Stack<Value> remainder;
+    if (!BinaryOpValues<BinaryFloorDiv>(a, b, quotient)) {
+        resultOut = quotient;
+        return false;
+    }
+    if (!BinaryOpValues<BinaryModulo>(a, b, remainder)) {
+        resultOut = remainder;
+        return false;
+    }
+
+    RootVector<Value> elements(2);
+    elements[0] = quotient;
+    elements[1] = remainder;
+    resultOut = Tuple::get(elements);
+    return true;
+}
+
+static bool builtin_sorted(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    // Keyword arguments are passed positionally by the wrapper in
+    // internals/internal.py.
+    Stack<Value> key(None);
+    if (args.size() > 1)
+        key = args[1];
+    bool reverse = args.size() > 2 && Value::IsTrue(args[2]);
+
+    Stack<List*> result(List::getUninitialised(0));
+    bool ok = ForEachElement(args[0], resultOut,
+                             [&] (Traced<Value> element,
+                                  MutableTraced<Value> errorOut) {
+        result->append(element);
+        return true;
+    });
+    if (!ok)
+        return false;
+
+    if (!result->sort(key, reverse, resultOut))
+        return false;
+
+    resultOut = Value(result);
+    return true;
+}
+
+static bool builtin_next(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (IteratorNext(args[0], resultOut))
+        return true;
+
+    if (args.size() == 2 && resultOut.is<StopIteration>()) {
+        resultOut = args[1];
+        return true;
+    }
+
+    return false;
+}
+
 static Value make_builtin_iter()
 {
     Stack<Env*> global;
@@ -101,20 +444,32 @@ static Env* GetOrCreateLocals()
 {
     Frame* frame = interp->getFrame();
     Stack<Env*> env(frame->env());
-    if (env && frame->block()->createEnv())
+    Stack<Block*> block(frame->block());
+    if (env && block->localsInEnv())
         return env;
 
     // todo: this is a check to see if we're in global scope
-    if (!frame->block()->parent())
-        return frame->block()->global();
+    if (!block->parent())
+        return block->global();
 
-    Stack<Layout*> layout(frame->block()->layout());
+    // Locals captured by nested scopes are stored in the frame's environment
+    // and the rest are on the stack.
+    Stack<Env*> capturedEnv(block->createEnv() ? env.get() : nullptr);
+    Stack<Layout*> layout(block->layout());
     Stack<Env*> parent;
     env = gc.create<Env>(parent, layout);
+    Stack<Value> value;
     while (layout != Layout::Empty) {
         unsigned index = layout->slotIndex();
-        Stack<Value> name(layout->name());
-        Stack<Value> value(interp->getStackLocal(index));
+        int envSlot = Layout::NotFound;
+        if (capturedEnv)
+            envSlot = block->envLayout()->lookupName(layout->name());
+        if (envSlot == Layout::NotFound)
+            value = interp->getStackLocal(index);
+        else if (capturedEnv->hasSlot(envSlot))
+            value = capturedEnv->getSlot(envSlot);
+        else
+            value = Value(UninitializedSlot);
         env->setSlot(index, value);
         layout = layout->parent();
     }
@@ -149,7 +504,7 @@ static Layout* CreateLayoutForDict(Traced<Dict*> dict)
 {
     Stack<Layout*> layout(Layout::Empty);
     for (const auto& i : dict->entries()) {
-        Stack<Value> key(i.first);
+        Stack<Value> key(i.key);
         if (key.is<String>()) {
             Name name = internString(key.as<String>()->value());
             layout = layout->addName(name);
@@ -162,9 +517,9 @@ static void SetAttrsFromDict(Traced<Dict*> dict, Traced<Object*> object)
 {
     unsigned slot = 0;
     for (const auto& i : dict->entries()) {
-        Stack<Value> key(i.first);
+        Stack<Value> key(i.key);
         if (key.is<String>())
-            object->setSlot(slot++, i.second);
+            object->setSlot(slot++, i.value);
     }
 }
 
@@ -361,6 +716,16 @@ void initBuiltins(const string& internalsPath)
     initNativeMethod(Builtin, "eval", builtin_eval, 1, 3);
     initNativeMethod(Builtin, "exec", builtin_exec, 1, 3);
     initNativeMethod(Builtin, "open", File::Open, 1, 2);
+    initNativeMethod(Builtin, "len", builtin_len, 1);
+    initNativeMethod(Builtin, "repr", builtin_repr, 1);
+    initNativeMethod(Builtin, "print", builtin_print, 0, UINT_MAX);
+    initNativeMethod(Builtin, "type", builtin_type, 1);
+    initNativeMethod(Builtin, "max", builtin_minmax<CompareGT>, 1, UINT_MAX);
+    initNativeMethod(Builtin, "min", builtin_minmax<CompareLT>, 1, UINT_MAX);
+    initNativeMethod(Builtin, "sum", builtin_sum, 1, 2);
+    initNativeMethod(Builtin, "divmod", builtin_divmod, 2);
+    initNativeMethod(Builtin, "sorted", builtin_sorted, 1, 3);
+    initNativeMethod(Builtin, "next", builtin_next, 1, 2);
 
     // Constants
     initAttr(Builtin, "True", Boolean::True);
@@ -378,6 +743,11 @@ void initBuiltins(const string& internalsPath)
     initAttr(Builtin, "int", Integer::ObjectClass);
     initAttr(Builtin, "float", Float::ObjectClass);
     initAttr(Builtin, "str", String::ObjectClass);
+    initAttr(Builtin, "range", Range::ObjectClass);
+    initAttr(Builtin, "zip", Zip::ObjectClass);
+    initAttr(Builtin, "map", Map::ObjectClass);
+    initAttr(Builtin, "enumerate", Enumerate::ObjectClass);
+    initAttr(Builtin, "filter", Filter::ObjectClass);
 
     // Exceptions
     initAttr(Builtin, "Exception", Exception::ObjectClass);
@@ -393,6 +763,7 @@ for_each_exception_class(set_exception_attr)
 
     Stack<Env*> internals(createTopLevel());
     internals->setAttr(Names::sys, Module::Sys);
+    internals->setAttr(Names::stopIteration, StopIterationException);
     initNativeMethod(internals, "execModule", internal_execModule, 4);
 
     filename = internalsPath + "/internal.py";
@@ -418,6 +789,9 @@ for_each_exception_class(set_exception_attr)
     value = internals->getAttr(Names::__import__);
     Builtin->setAttr(Names::__import__, value);
 
+    value = internals->getAttr(Names::sorted);
+    Builtin->setAttr(Names::sorted, value);
+
     builtinsInitialised = true;
 }
 
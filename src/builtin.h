@@ -2,6 +2,7 @@
 #define __BUILTIN_H__
 
 #include "object.h"
+#include "specials.h"
 
 struct Env;
 struct Function;
@@ -17,6 +18,12 @@ extern GlobalRoot<Function*> LoadModule;
 
 extern bool builtinsInitialised;
 
+// Compare two values with a comparison operator, trying the reflected method
+// if necessary.  Only CompareLT is instantiated outside builtin.cpp.
+template <CompareOp Op>
+bool CompareValues(Traced<Value> left, Traced<Value> right,
+                   bool& resultOut, MutableTraced<Value> errorOut);
+
 extern void initBuiltins(const string& internalsPath);
 extern void finalBuiltins();
 
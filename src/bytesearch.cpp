@@ -0,0 +1,140 @@
+#include "bytesearch.h"
+
+#include "assert.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+typedef const char* (FindFunc)(const char* haystack, size_t length,
+                               const char* needle, size_t needleLength);
+
+// All the implementations below require a needle of at least two bytes that
+// is no longer than the haystack.
+
+static const char* FindBytesScalar(const char* haystack, size_t length,
+                                   const char* needle, size_t needleLength)
+{
+    if (needleLength > length)
+        return nullptr;
+
+    const char* end = haystack + length - needleLength + 1;
+    const char* p = haystack;
+    while (p < end) {
+        p = static_cast<const char*>(memchr(p, needle[0], end - p));
+        if (!p)
+            return nullptr;
+        if (memcmp(p + 1, needle + 1, needleLength - 1) == 0)
+            return p;
+        p++;
+    }
+    return nullptr;
+}
+
+#ifdef USE_X86_SIMD
+
+// Compare each position in a block against the first and last bytes of the
+// needle and only check the rest of the needle at positions where both match.
+
+static const char* FindBytesSSE2(const char* haystack, size_t length,
+                                 const char* needle, size_t needleLength)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+    size_t i = 0;
+    for (; i + 16 + needleLength - 1 <= length; i += 16) {
+        const char* block = haystack + i;
+        __m128i blockFirst =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+        __m128i blockLast = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(block + needleLength - 1));
+        unsigned mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst),
+                          _mm_cmpeq_epi8(last, blockLast)));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (memcmp(block + bit + 1, needle + 1, needleLength - 2) == 0)
+                return block + bit;
+            mask &= mask - 1;
+        }
+    }
+    return FindBytesScalar(haystack + i, length - i, needle, needleLength);
+}
+
+__attribute__((target("avx2")))
+static const char* FindBytesAVX2(const char* haystack, size_t length,
+                                 const char* needle, size_t needleLength)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+    size_t i = 0;
+    for (; i + 32 + needleLength - 1 <= length; i += 32) {
+        const char* block = haystack + i;
+        __m256i blockFirst =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        __m256i blockLast = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(block + needleLength - 1));
+        uint32_t mask = _mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst),
+                             _mm256_cmpeq_epi8(last, blockLast)));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (memcmp(block + bit + 1, needle + 1, needleLength - 2) == 0)
+                return block + bit;
+            mask &= mask - 1;
+        }
+    }
+    return FindBytesSSE2(haystack + i, length - i, needle, needleLength);
+}
+
+static FindFunc* ChooseFindFunc()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return FindBytesAVX2;
+    return FindBytesSSE2;
+}
+
+#else
+
+static FindFunc* ChooseFindFunc()
+{
+    return FindBytesScalar;
+}
+
+#endif
+
+static FindFunc* const FindBytesImpl = ChooseFindFunc();
+
+const char* FindBytes(const char* haystack, size_t length,
+                      const char* needle, size_t needleLength)
+{
+    if (needleLength == 0)
+        return haystack;
+    if (needleLength > length)
+        return nullptr;
+    if (needleLength == 1) {
+        // The C library already vectorizes this.
+        return static_cast<const char*>(memchr(haystack, needle[0], length));
+    }
+
+    return FindBytesImpl(haystack, length, needle, needleLength);
+}
+
+size_t CountBytes(const char* haystack, size_t length,
+                  const char* needle, size_t needleLength)
+{
+    assert(needleLength != 0);
+    const char* end = haystack + length;
+    size_t count = 0;
+    const char* p = haystack;
+    while ((p = FindBytes(p, end - p, needle, needleLength))) {
+        count++;
+        p += needleLength;
+    }
+    return count;
+}
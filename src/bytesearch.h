@@ -0,0 +1,19 @@
+#ifndef __BYTESEARCH_H__
+#define __BYTESEARCH_H__
+
+#include <cstddef>
+
+// Find the first occurrence of needle in the length bytes starting at
+// haystack, returning a pointer to it or nullptr if not found.  An empty needle
+// is found at the start.
+//
+// On x86 this scans sixteen or thirty two bytes at a time using SSE2 or AVX2,
+// checking the first and last bytes of the needle before comparing the rest.
+extern const char* FindBytes(const char* haystack, size_t length,
+                             const char* needle, size_t needleLength);
+
+// Count the non-overlapping occurrences of a non-empty needle.
+extern size_t CountBytes(const char* haystack, size_t length,
+                         const char* needle, size_t needleLength);
+
+#endif
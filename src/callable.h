@@ -36,6 +36,8 @@ struct Native : public Callable
         return func_(args, resultOut);
     }
 
+    NativeFunc func() const { return func_; }
+
   private:
     NativeFunc func_;
 };
@@ -79,6 +81,7 @@ struct Function : public Callable
         return info_->params_[i];
     }
 
+    FunctionInfo* info() const { return info_; }
     Block* block() const { return info_->block_; }
     Env* env() const { return env_; }
     bool takesRest() const  { return info_->takesRest(); }
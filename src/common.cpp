@@ -9,12 +9,14 @@
 #include "file.h"
 #include "input.h"
 #include "interp.h"
+#include "iterator.h"
 #include "name.h"
 #include "numeric.h"
 #include "list.h"
 #include "module.h"
 #include "object.h"
 #include "parser.h"
+#include "range.h"
 #include "reflect.h"
 #include "singletons.h"
 #include "slice.h"
@@ -40,6 +42,8 @@ void init1()
     Float::init();
     Exception::init();
     initList();
+    initRange();
+    initIterators();
     Slice::init();
     Dict::init();
     DictView::init();
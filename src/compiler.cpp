@@ -5,6 +5,7 @@
 #include "exception.h"
 #include "frame.h"
 #include "instr.h"
+#include "list.h"
 #include "parser.h"
 #include "repr.h"
 #include "reflect.h"
@@ -48,6 +49,18 @@ static inline void logBranchHere(unsigned index, int stackDepth,
     }
 }
 
+static inline void logFold(const Syntax& s, Traced<Value> result)
+{
+    if (logCompile)
+        cout << "bc:   fold " << s << " => " << result << endl;
+}
+
+static inline void logSkip(const char* message, const Syntax& s)
+{
+    if (logCompile)
+        cout << "bc:   skip " << message << " " << s << endl;
+}
+
 #else
 
 static inline void log(const Block* block) {}
@@ -56,9 +69,225 @@ static inline void logBuild(unsigned argCount) {}
 static inline void logEmit(unsigned index, Instr* instr, int stackDepth) {}
 static inline void logBranchHere(unsigned index, int stackDepth,
                                  int sourceStackDepth) {}
+static inline void logFold(const Syntax& s, Traced<Value> result) {}
+static inline void logSkip(const char* message, const Syntax& s) {}
 
 #endif
 
+// Constant folding.
+//
+// Expressions made up entirely of literals of builtin immutable types are
+// evaluated at compile time by calling the same native methods the interpreter
+// would call at runtime.  Anything that could raise or produce an unreasonably
+// large constant is left to be evaluated at runtime.
+
+static const size_t MaxFoldedIntegerBits = 128;
+static const size_t MaxFoldedStringLength = 4096;
+static const int32_t MaxFoldedExponent = 128;
+
+static bool IsFoldableOperand(Traced<Value> value)
+{
+    Stack<Class*> cls(value.type());
+    return cls == Integer::ObjectClass || cls == Boolean::ObjectClass ||
+           cls == Float::ObjectClass || cls == String::ObjectClass;
+}
+
+static bool IsFoldableResult(Traced<Value> value)
+{
+    if (value.isInt32() || value.isDouble())
+        return true;
+
+    if (value.is<Integer>()) {
+        const mpz_class& v = value.as<Integer>()->value();
+        return mpz_sizeinbase(v.get_mpz_t(), 2) <= MaxFoldedIntegerBits;
+    }
+
+    if (value.is<String>())
+        return value.as<String>()->size() <= MaxFoldedStringLength;
+
+    return value.is<Boolean>() || value.is<Float>();
+}
+
+static bool IsZero(Traced<Value> value)
+{
+    if (value.isInt32())
+        return value.asInt32() == 0;
+    return value.isFloat() && value.toFloat() == 0.0;
+}
+
+static bool CanFoldBinaryOp(BinaryOp op, Traced<Value> left,
+                            Traced<Value> right)
+{
+    switch (op) {
+      case BinaryTrueDiv:
+      case BinaryFloorDiv:
+      case BinaryModulo:
+        return !IsZero(right);
+
+      case BinaryPower:
+      case BinaryLeftShift:
+      case BinaryRightShift:
+        if (right.isInt32()) {
+            return right.asInt32() >= 0 &&
+                   right.asInt32() <= MaxFoldedExponent;
+        }
+        return right.isDouble() && op == BinaryPower;
+
+      default:
+        return true;
+    }
+}
+
+static bool FoldMethodCall(Traced<Value> target, Name name,
+                           const TracedVector<Value>& args,
+                           MutableTraced<Value> resultOut)
+{
+    Stack<Class*> cls(target.type());
+    Stack<Value> method;
+    if (!cls->maybeGetClassAttr(name, method) || !method.is<Native>())
+        return false;
+
+    Stack<Native*> native(method.as<Native>());
+    if (args.size() < native->minArgs() || args.size() > native->maxArgs())
+        return false;
+
+    return native->call(args, resultOut) &&
+           resultOut != Value(NotImplemented);
+}
+
+static bool FoldUnaryMethod(Traced<Value> value, Name name,
+                            MutableTraced<Value> resultOut)
+{
+    RootVector<Value> args;
+    args.push_back(value);
+    return FoldMethodCall(value, name, args, resultOut);
+}
+
+static bool FoldBinaryMethod(Traced<Value> left, Traced<Value> right,
+                             Name name, Name reflectedName,
+                             MutableTraced<Value> resultOut)
+{
+    RootVector<Value> args;
+    args.push_back(left);
+    args.push_back(right);
+    if (FoldMethodCall(left, name, args, resultOut))
+        return true;
+
+    args[0] = right;
+    args[1] = left;
+    return FoldMethodCall(right, reflectedName, args, resultOut);
+}
+
+static bool FoldConstant(const Syntax& s, MutableTraced<Value> resultOut);
+
+template <typename T>
+static bool FoldOperands(const T& s,
+                         MutableTraced<Value> leftOut,
+                         MutableTraced<Value> rightOut)
+{
+    return FoldConstant(*s.left, leftOut) &&
+           IsFoldableOperand(leftOut) &&
+           FoldConstant(*s.right, rightOut) &&
+           IsFoldableOperand(rightOut);
+}
+
+static bool FoldConstantExpr(const Syntax& s, MutableTraced<Value> resultOut)
+{
+    Stack<Value> left;
+    Stack<Value> right;
+
+    switch (s.type()) {
+      case SyntaxType::Integer:
+        resultOut = Integer::get(s.token.text);
+        return true;
+
+      case SyntaxType::Float:
+        resultOut = Float::get(s.as<SyntaxFloat>()->value);
+        return true;
+
+      case SyntaxType::String:
+        resultOut = String::get(s.as<SyntaxString>()->value);
+        return true;
+
+      case SyntaxType::Name: {
+        // These are keywords in Python 3 and so can't be rebound.
+        Name id = s.as<SyntaxName>()->id;
+        if (id == Names::True)
+            resultOut = Boolean::True;
+        else if (id == Names::False)
+            resultOut = Boolean::False;
+        else if (id == Names::None)
+            resultOut = None;
+        else
+            return false;
+        return true;
+      }
+
+      case SyntaxType::ExprList: {
+        const auto& elements = s.as<SyntaxExprList>()->elements;
+        RootVector<Value> values(elements.size());
+        for (size_t i = 0; i < elements.size(); i++) {
+            if (!FoldConstant(*elements[i], values.ref(i)))
+                return false;
+        }
+        resultOut = Tuple::get(values);
+        return true;
+      }
+
+      case SyntaxType::Not:
+        if (!FoldConstant(*s.as<SyntaxNot>()->right, right))
+            return false;
+        resultOut = Boolean::get(!Value::IsTrue(right));
+        return true;
+
+      case SyntaxType::Pos:
+      case SyntaxType::Neg:
+      case SyntaxType::Invert: {
+        const UnarySyntax& u = static_cast<const UnarySyntax&>(s);
+        if (!FoldConstant(*u.right, right) || !IsFoldableOperand(right))
+            return false;
+        Name name = s.is<SyntaxPos>() ? Names::__pos__ :
+                    s.is<SyntaxNeg>() ? Names::__neg__ : Names::__invert__;
+        return FoldUnaryMethod(right, name, resultOut);
+      }
+
+      case SyntaxType::BinaryOp: {
+        const SyntaxBinaryOp& b = *s.as<SyntaxBinaryOp>();
+        if (!FoldOperands(b, left, right) ||
+            !CanFoldBinaryOp(b.op, left, right))
+        {
+            return false;
+        }
+        return FoldBinaryMethod(left, right,
+                                Names::binMethod[b.op],
+                                Names::binMethodReflected[b.op],
+                                resultOut);
+      }
+
+      case SyntaxType::CompareOp: {
+        const SyntaxCompareOp& c = *s.as<SyntaxCompareOp>();
+        if (!FoldOperands(c, left, right))
+            return false;
+        return FoldBinaryMethod(left, right,
+                                Names::compareMethod[c.op],
+                                Names::compareMethodReflected[c.op],
+                                resultOut);
+      }
+
+      default:
+        return false;
+    }
+}
+
+static bool FoldConstant(const Syntax& s, MutableTraced<Value> resultOut)
+{
+    if (!FoldConstantExpr(s, resultOut))
+        return false;
+
+    return resultOut.is<Tuple>() || resultOut.isNone() ||
+           IsFoldableResult(resultOut);
+}
+
 struct ByteCompiler : public SyntaxVisitor
 {
     ByteCompiler()
@@ -307,6 +536,23 @@ struct ByteCompiler : public SyntaxVisitor
         block->branchHere(index);
     }
 
+    // Add an exception handler covering the instructions emitted from here
+    // until the compiler sets the end of its range.
+    unsigned addExceptionHandler(ExceptionHandler::Type type) {
+        assert(stackDepth != -1);
+        return block->addExceptionHandler(type, stackDepth);
+    }
+
+    // Set an exception handler's target to the next instruction.
+    void exceptionHandlerHere(unsigned index) {
+        const ExceptionHandler& handler = block->exceptionHandler(index);
+        if (stackDepth == -1)
+            stackDepth = handler.stackDepth;
+        else
+            assert(unsigned(stackDepth) == handler.stackDepth);
+        block->setExceptionHandlerTarget(index);
+    }
+
     void compile(const Syntax* s) {
         compile(*s);
     }
@@ -331,6 +577,33 @@ struct ByteCompiler : public SyntaxVisitor
         breakInstrs.clear();
     }
 
+    bool maybeCompileConstant(const Syntax& s) {
+        Stack<Value> value;
+        if (!FoldConstant(s, value))
+            return false;
+
+        if (!s.is<SyntaxName>())
+            logFold(s, value);
+        emit<Instr_Const>(value);
+        return true;
+    }
+
+    // Determine whether a condition is a compile time constant, and if so
+    // whether it's true.
+    bool foldCondition(const Syntax& cond, bool& valueOut) {
+        Stack<Value> value;
+        if (!FoldConstant(cond, value))
+            return false;
+
+        valueOut = Value::IsTrue(value);
+        return true;
+    }
+
+    static bool isTerminator(const Syntax& s) {
+        return s.is<SyntaxReturn>() || s.is<SyntaxRaise>() ||
+               s.is<SyntaxBreak>() || s.is<SyntaxContinue>();
+    }
+
     void maybeAssertStackDepth() {
 #if defined(DEBUG)
         if (assertStackDepth && stackDepth != -1)
@@ -348,17 +621,27 @@ struct ByteCompiler : public SyntaxVisitor
         assert(!parent || kind == Kind::ListComp ||
                kind == Kind::Eval || kind == Kind::Exec ||
                layout->slotCount() == argCount);
-        bool hasNestedFuctions;
-        defs = FindDefinitions(s, layout, globals, hasNestedFuctions);
-        useLexicalEnv = useLexicalEnv || hasNestedFuctions;
+        vector<Name> captured;
+        defs = FindDefinitions(s, layout, globals, captured);
         if (kind == Kind::Module) {
             assert(!parent);
             topLevel->extend(layout);
         }
         layout = defs->layout();
         assert(layout->slotCount() >= argCount);
+
+        // Locals are stored on the stack unless they are captured by a nested
+        // scope, in which case they are stored in an environment created for
+        // each call.  Class bodies and eval/exec code store all their locals
+        // in an environment.
+        Stack<Layout*> capturedLayout;
+        if (!useLexicalEnv && parent && !captured.empty()) {
+            capturedLayout = Env::InitialLayout;
+            for (Name name : captured)
+                capturedLayout = capturedLayout->addName(name);
+        }
         block = gc.create<Block>(parent, topLevel, layout, argCount,
-                                 useLexicalEnv);
+                                 useLexicalEnv, capturedLayout);
 
         stackDepth = (kind != Kind::Module ? 1 : 0) + argCount;
         maybeAssertStackDepth();
@@ -371,6 +654,7 @@ struct ByteCompiler : public SyntaxVisitor
                     emit<Instr_CreateEnv>();
             } else {
                 emit<Instr_InitStackLocals>(block->stackLocalCount());
+                copyCapturedArgsToEnv();
             }
             maybeAssertStackDepth();
         }
@@ -391,6 +675,25 @@ struct ByteCompiler : public SyntaxVisitor
         block->setMaxStackDepth(maxStackDepth + 2);
     }
 
+    void copyCapturedArgsToEnv() {
+        if (!block->createEnv())
+            return;
+
+        Stack<Layout*> envLayout(block->envLayout());
+        for (unsigned i = 0; i < block->argCount(); i++) {
+            Stack<Layout*> argLayout(layout);
+            while (argLayout->slotIndex() != i)
+                argLayout = argLayout->parent();
+            Name name = argLayout->name();
+            int slot = envLayout->lookupName(name);
+            if (slot != Layout::NotFound) {
+                emit<Instr_GetStackLocal>(name, i);
+                emit<Instr_SetLexicalSlot>(0, name, slot);
+                emit<Instr_Pop>();
+            }
+        }
+    }
+
     void callUnaryMethod(const UnarySyntax& s, Name name) {
         compile(s.right);
         emit<Instr_GetMethod>(name);
@@ -421,15 +724,21 @@ struct ByteCompiler : public SyntaxVisitor
 
     virtual void visit(const SyntaxBlock& s) {
         maybeAssertStackDepth();
-        bool first = true;
-        for (const auto& i : s.statements) {
-            if (!first)
+        const auto& statements = s.statements;
+        for (size_t i = 0; i < statements.size(); i++) {
+            if (i != 0)
                 emit<Instr_Pop>();
-            compile(i);
+            compile(statements[i]);
             maybeAssertStackDepth();
-            first = false;
+
+            // Don't emit unreachable code.
+            if (isTerminator(*statements[i])) {
+                for (size_t j = i + 1; j < statements.size(); j++)
+                    logSkip("unreachable", *statements[j]);
+                break;
+            }
         }
-        if (first)
+        if (statements.empty())
             emit<Instr_Const>(None);
     }
 
@@ -449,6 +758,9 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxExprList& s) {
+        if (maybeCompileConstant(s))
+            return;
+
         for (const auto& i : s.elements)
             compile(*i);
         emit<Instr_Tuple>(s.elements.size());
@@ -475,6 +787,12 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxOr& s) {
+        bool leftValue;
+        if (foldCondition(*s.left, leftValue)) {
+            compile(leftValue ? s.left : s.right);
+            return;
+        }
+
         compile(s.left);
         unsigned branch = emit<Instr_Or>();
         emit<Instr_Pop>();
@@ -483,6 +801,12 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxAnd& s) {
+        bool leftValue;
+        if (foldCondition(*s.left, leftValue)) {
+            compile(leftValue ? s.right : s.left);
+            return;
+        }
+
         compile(s.left);
         unsigned branch = emit<Instr_And>();
         emit<Instr_Pop>();
@@ -491,23 +815,38 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxNot& s) {
+        if (maybeCompileConstant(s))
+            return;
+
         compile(s.right);
         emit<Instr_Not>();
     }
 
     virtual void visit(const SyntaxPos& s) {
+        if (maybeCompileConstant(s))
+            return;
+
         callUnaryMethod(s, Names::__pos__);
     }
 
     virtual void visit(const SyntaxNeg& s) {
+        if (maybeCompileConstant(s))
+            return;
+
         callUnaryMethod(s, Names::__neg__);
     }
 
     virtual void visit(const SyntaxInvert& s) {
+        if (maybeCompileConstant(s))
+            return;
+
         callUnaryMethod(s, Names::__invert__);
     }
 
     virtual void visit(const SyntaxBinaryOp& s) {
+        if (maybeCompileConstant(s))
+            return;
+
         compile(s.left);
         compile(s.right);
         emit<Instr_BinaryOp>(s.op);
@@ -526,6 +865,9 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxCompareOp& s) {
+        if (maybeCompileConstant(s))
+            return;
+
         compile(s.left);
         compile(s.right);
         emit<Instr_CompareOp>(s.op);
@@ -558,23 +900,37 @@ struct ByteCompiler : public SyntaxVisitor
     bool lookupLocal(Name name, int& slotOut) {
         if (!parent || useLexicalEnv)
             return false;
+        if (block->createEnv() && block->envLayout()->hasName(name))
+            return false;
         slotOut = layout->lookupName(name);
         return slotOut != Layout::NotFound;
     }
 
-    bool lookupLexical(Name name, unsigned& frameOut) {
+    // Find the environment containing a name defined in an enclosing scope.
+    // Sets slotOut to the name's slot if the environment holds only captured
+    // variables, or to Layout::NotFound if it holds all the block's locals and
+    // must be accessed by name.
+    bool lookupLexical(Name name, unsigned& frameOut, int& slotOut) {
         // todo: this looks wrong
         if (contains(globals, name))
             return false;
 
         int frame = 0;
-        Stack<Block*> block(useLexicalEnv ? this->block : parent);
+        Stack<Block*> block(this->block);
         while (block && block->parent()) {
             if (block->layout()->hasName(name)) {
+                // Analysis should have found all captured variables.
+                assert(block->createEnv());
+                assert(block->envLayout()->hasName(name));
                 frameOut = frame;
+                if (block->localsInEnv())
+                    slotOut = Layout::NotFound;
+                else
+                    slotOut = block->envLayout()->lookupName(name);
                 return true;
             }
-            ++frame;
+            if (block->createEnv())
+                ++frame;
             block = block->parent();
         }
         return false;
@@ -592,8 +948,11 @@ struct ByteCompiler : public SyntaxVisitor
         unsigned frame;
         if (lookupLocal(name, slot)) {
             emit<Instr_SetStackLocal>(name, slot);
-        } else if (lookupLexical(name, frame)) {
-            emit<Instr_SetLexical>(frame, name);
+        } else if (lookupLexical(name, frame, slot)) {
+            if (slot != Layout::NotFound)
+                emit<Instr_SetLexicalSlot>(frame, name, slot);
+            else
+                emit<Instr_SetLexical>(frame, name);
         } else {
             assert(lookupGlobal(name));
             emit<Instr_SetGlobal>(topLevel, name);
@@ -605,8 +964,11 @@ struct ByteCompiler : public SyntaxVisitor
         unsigned frame;
         if (lookupLocal(name, slot)) {
             emit<Instr_DelStackLocal>(name, slot);
-        } else if (lookupLexical(name, frame)) {
-            emit<Instr_DelLexical>(frame, name);
+        } else if (lookupLexical(name, frame, slot)) {
+            if (slot != Layout::NotFound)
+                emit<Instr_DelLexicalSlot>(frame, name, slot);
+            else
+                emit<Instr_DelLexical>(frame, name);
         } else {
             assert(lookupGlobal(name));
             emit<Instr_DelGlobal>(topLevel, name);
@@ -617,12 +979,16 @@ struct ByteCompiler : public SyntaxVisitor
     void compileReference(Name name) {
         int slot;
         unsigned frame;
-        if (lookupLocal(name, slot))
+        if (lookupLocal(name, slot)) {
             emit<Instr_GetStackLocal>(name, slot);
-        else if (lookupLexical(name, frame))
-            emit<Instr_GetLexical>(frame, name);
-        else
+        } else if (lookupLexical(name, frame, slot)) {
+            if (slot != Layout::NotFound)
+                emit<Instr_GetLexicalSlot>(frame, name, slot);
+            else
+                emit<Instr_GetLexical>(frame, name);
+        } else {
             emit<Instr_GetGlobal>(topLevel, name);
+        }
     }
 
     virtual void visit(const SyntaxName& s) {
@@ -636,7 +1002,8 @@ struct ByteCompiler : public SyntaxVisitor
             break;
 
           default:
-            compileReference(s.id);
+            if (!maybeCompileConstant(s))
+                compileReference(s.id);
             break;
         }
     }
@@ -669,13 +1036,8 @@ struct ByteCompiler : public SyntaxVisitor
           case Context::Assign: {
             AutoPushContext clearContext(contextStack, Context::None);
             compile(s.left);
-            emit<Instr_GetMethod>(Names::__setitem__);
             compile(s.right);
-            // todo: there may be a better way than this stack manipulation
-            emit<Instr_Dup>(3);
-            emit<Instr_CallMethod>(2);
-            emit<Instr_Swap>();
-            emit<Instr_Pop>();
+            emit<Instr_SetItem>();
             break;
           }
 
@@ -686,7 +1048,9 @@ struct ByteCompiler : public SyntaxVisitor
           }
 
           default:
-            callBinaryMethod(s, Names::__getitem__);
+            compile(s.left);
+            compile(s.right);
+            emit<Instr_GetItem>();
             break;
         }
     }
@@ -740,6 +1104,21 @@ struct ByteCompiler : public SyntaxVisitor
             compile(s.target);
         }
 
+        // Calls that just forward an argument sequence and optional mapping,
+        // e.g. f(*args, **kwargs), can pass them to the callee without
+        // unpacking them onto the stack.
+        if (!methodCall && s.positionalArgs.size() == 1 &&
+            s.positionalArgs[0]->isUnpacked && s.keywordArgs.empty())
+        {
+            compile(*s.positionalArgs[0]->arg);
+            if (s.mappingArg)
+                compile(*s.mappingArg);
+            maxStackDepth = max(stackDepth + 1, maxStackDepth);
+            emit<Instr_CallUnpacked>(s.mappingArg ? 2 : 1);
+            assert(stackDepth == initialStackDepth + 1);
+            return;
+        }
+
         int argsPos = stackDepth;
         size_t unpackedCount = 0;
         for (const auto& i : s.positionalArgs) {
@@ -819,6 +1198,12 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxCond& s) {
+        bool condValue;
+        if (foldCondition(*s.cond, condValue)) {
+            compile(condValue ? s.cons : s.alt);
+            return;
+        }
+
         compile(s.cond);
         unsigned altBranch = emit<Instr_BranchIfFalse>();
         compile(s.cons);
@@ -831,20 +1216,37 @@ struct ByteCompiler : public SyntaxVisitor
     virtual void visit(const SyntaxIf& s) {
         const auto& suites = s.branches;
         assert(suites.size() != 0);
+        const Syntax* elseSuite = s.elseSuite.get();
         vector<unsigned> branchesToEnd;
+        bool haveCondFailed = false;
         unsigned lastCondFailed = 0;
         for (unsigned i = 0; i != suites.size(); ++i) {
-            if (i != 0)
+            // Branches with constant conditions are either removed entirely
+            // or become the else clause, making any following ones dead.
+            bool condValue;
+            bool isConstant = foldCondition(*suites[i].cond, condValue);
+            if (isConstant && !condValue) {
+                logSkip("if branch", *suites[i].suite);
+                continue;
+            }
+            if (haveCondFailed)
                 branchHereFrom(lastCondFailed);
+            haveCondFailed = false;
+            if (isConstant) {
+                elseSuite = suites[i].suite.get();
+                break;
+            }
             compile(suites[i].cond);
             lastCondFailed = emit<Instr_BranchIfFalse>();
+            haveCondFailed = true;
             compile(suites[i].suite);
             branchesToEnd.push_back(emit<Instr_BranchAlways>());
         }
-        branchHereFrom(lastCondFailed);
+        if (haveCondFailed)
+            branchHereFrom(lastCondFailed);
 
-        if (s.elseSuite)
-            compile(s.elseSuite);
+        if (elseSuite)
+            compile(elseSuite);
         else
             emit<Instr_Const>(None);
         for (unsigned i = 0; i < branchesToEnd.size(); ++i)
@@ -852,35 +1254,89 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxWhile& s) {
+        // A constant condition means we either skip the loop entirely or
+        // don't need to test the condition.
+        bool condValue;
+        bool isConstant = foldCondition(*s.cond, condValue);
+        if (isConstant && !condValue) {
+            logSkip("while", *s.suite);
+            emit<Instr_Const>(None);
+            return;
+        }
+
+        int initialStackDepth = stackDepth;
         AutoSetAndRestoreOffset setLoopHead(loopHeadOffset, block->nextIndex());
         vector<unsigned> oldBreakInstrs = move(breakInstrs);
         breakInstrs.clear();
-        compile(s.cond);
-        unsigned branchToEnd = emit<Instr_BranchIfFalse>();
+        unsigned branchToEnd = 0;
+        if (!isConstant) {
+            compile(s.cond);
+            branchToEnd = emit<Instr_BranchIfFalse>();
+        }
         {
             AutoPushContext enterLoop(contextStack, Context::Loop);
             compile(s.suite);
             emit<Instr_Pop>();
         }
         emit<Instr_BranchAlways>(block->offsetTo(loopHeadOffset));
-        branchHereFrom(branchToEnd);
+        if (!isConstant)
+            branchHereFrom(branchToEnd);
+        else
+            stackDepth = initialStackDepth; // Only reachable by break.
         setBreakTargets();
         breakInstrs = move(oldBreakInstrs);
         emit<Instr_Const>(None);
         // todo: else
     }
 
+    // Check whether a for loop iterates over a call to range() with simple
+    // positional arguments.  Such loops can use a counter rather than
+    // allocating an iterator if the name turns out to be the builtin range.
+    static const SyntaxCall* isRangeCall(const Syntax& s) {
+        if (!s.is<SyntaxCall>())
+            return nullptr;
+
+        const SyntaxCall* call = s.as<SyntaxCall>();
+        if (!call->target->is<SyntaxName>() ||
+            call->target->as<SyntaxName>()->id != Names::range ||
+            call->positionalArgs.empty() ||
+            call->positionalArgs.size() > 3 ||
+            !call->keywordArgs.empty() ||
+            call->mappingArg)
+        {
+            return nullptr;
+        }
+
+        for (const auto& i : call->positionalArgs) {
+            if (i->isUnpacked)
+                return nullptr;
+        }
+
+        return call;
+    }
+
     virtual void visit(const SyntaxFor& s) {
         // 1. Get iterator
-        compile(s.exprs);
-        emit<Instr_GetIterator>();
-        emit<Instr_GetMethod>(Names::__next__);
+        const SyntaxCall* rangeCall = isRangeCall(*s.exprs);
+        if (rangeCall) {
+            compile(rangeCall->target);
+            for (const auto& i : rangeCall->positionalArgs)
+                compile(*i->arg);
+            emit<Instr_GetRangeIterator>(rangeCall->positionalArgs.size());
+        } else {
+            compile(s.exprs);
+            emit<Instr_GetIterator>();
+            emit<Instr_GetMethod>(Names::__next__);
+        }
 
         // 2. Call next on iterator and break if end (loop head)
         AutoSetAndRestoreOffset setLoopHead(loopHeadOffset, block->nextIndex());
         vector<unsigned> oldBreakInstrs = move(breakInstrs);
         breakInstrs.clear();
-        emit<Instr_IteratorNext>();
+        if (rangeCall)
+            emit<Instr_RangeIteratorNext>();
+        else
+            emit<Instr_IteratorNext>();
         unsigned exitBranch = emit<Instr_BranchIfFalse>();
 
         // 3. Assign results
@@ -912,6 +1368,8 @@ struct ByteCompiler : public SyntaxVisitor
         breakInstrs = move(oldBreakInstrs);
         emit<Instr_Pop>();
         emit<Instr_Pop>();
+        if (rangeCall)
+            emit<Instr_Pop>();
         emit<Instr_Const>(None);
     }
 
@@ -978,13 +1436,7 @@ struct ByteCompiler : public SyntaxVisitor
         emit<Instr_Call>(1);
         for (size_t i = 0; i < s.decorators.size(); i++)
             emit<Instr_Call>(1);
-        if (parent) {
-            int slot;
-            alwaysTrue(lookupLocal(s.id, slot));
-            emit<Instr_SetStackLocal>(s.id, slot);
-        } else {
-            emit<Instr_SetGlobal>(topLevel, s.id);
-        }
+        compileAssign(s.id);
     }
 
     virtual void visit(const SyntaxDecorator& s) {
@@ -992,7 +1444,8 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxAssert& s) {
-        if (debugMode) {
+        bool condValue;
+        if (debugMode && !(foldCondition(*s.cond, condValue) && condValue)) {
             compile(s.cond);
             unsigned endBranch = emit<Instr_BranchIfTrue>();
             if (s.message) {
@@ -1020,10 +1473,11 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     virtual void visit(const SyntaxTry& s) {
-        unsigned finallyBranch = 0;
+        unsigned finallyHandler = 0;
         if (s.finallySuite) {
             contextStack.push_back(Context::Finally);
-            finallyBranch = emit<Instr_EnterFinallyRegion>();
+            finallyHandler = addExceptionHandler(
+                ExceptionHandler::FinallyHandler);
         }
         if (s.excepts.size() != 0) {
             emitTryExcept(s);
@@ -1032,8 +1486,8 @@ struct ByteCompiler : public SyntaxVisitor
             emit<Instr_Pop>();
         }
         if (s.finallySuite) {
-            emit<Instr_LeaveFinallyRegion>();
-            branchHereFrom(finallyBranch);
+            block->setExceptionHandlerEnd(finallyHandler);
+            exceptionHandlerHere(finallyHandler);
             compile(s.finallySuite);
             emit<Instr_Pop>();
             emit<Instr_FinishExceptionHandler>();
@@ -1044,17 +1498,23 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     void emitTryExcept(const SyntaxTry& s) {
-        unsigned handlerBranch = emit<Instr_EnterCatchRegion>();
+        unsigned handler = addExceptionHandler(ExceptionHandler::CatchHandler);
         compile(s.trySuite);
         emit<Instr_Pop>();
-        emit<Instr_LeaveCatchRegion>();
+        block->setExceptionHandlerEnd(handler);
         unsigned suiteEndBranch = emit<Instr_BranchAlways>();
 
         bool fullyHandled = false;
+        bool firstExcept = true;
+        unsigned handlerBranch = 0;
         vector<unsigned> exceptEndBranches;
         for (const auto& e : s.excepts) {
             assert(!fullyHandled);
-            branchHereFrom(handlerBranch);
+            if (firstExcept)
+                exceptionHandlerHere(handler);
+            else
+                branchHereFrom(handlerBranch);
+            firstExcept = false;
             if (e->expr) {
                 compile(e->expr);
                 emit<Instr_MatchCurrentException>();
@@ -1204,7 +1664,7 @@ struct ByteCompiler : public SyntaxVisitor
 
         if (s.ids.empty()) {
             // todo
-            value = gc.create<String>("import * not implemented");
+            value = String::get("import * not implemented");
             emit<Instr_Const>(value);
             emit<Instr_AssertionFailed>();
             return;
@@ -1232,23 +1692,15 @@ struct ByteCompiler : public SyntaxVisitor
     }
 
     void compileListComp(const Syntax& s) {
-        // Set up results variable to hold the array
+        // Set up results variable to hold the array.  This is always the first
+        // stack local since it can't be captured by a nested scope.
 #ifdef DEBUG
-        if (useLexicalEnv) {
-            unsigned frame;
-            assert(lookupLexical(Names::listCompResult, frame));
-            assert(frame == 0);
-        } else {
-            int slot;
-            assert(lookupLocal(Names::listCompResult, slot));
-            assert(slot == 0);
-        }
+        int slot;
+        assert(lookupLocal(Names::listCompResult, slot));
+        assert(slot == 0);
 #endif
         emit<Instr_List>(0);
-        if (useLexicalEnv)
-            emit<Instr_SetLexical>(0, Names::listCompResult);
-        else
-            emit<Instr_SetStackLocal>(Names::listCompResult, 0);
+        emit<Instr_SetStackLocal>(Names::listCompResult, 0);
         emit<Instr_Pop>();
 
         // Compile expression to generate results
@@ -1256,18 +1708,12 @@ struct ByteCompiler : public SyntaxVisitor
 
         // Fetch result
         emit<Instr_Pop>();
-        if (useLexicalEnv)
-            emit<Instr_GetLexical>(0, Names::listCompResult);
-        else
-            emit<Instr_GetStackLocal>(Names::listCompResult, 0);
+        emit<Instr_GetStackLocal>(Names::listCompResult, 0);
     }
 
     virtual void visit(const SyntaxCompIterand& s) {
         assert(kind == Kind::ListComp);
-        if (useLexicalEnv)
-            emit<Instr_GetLexical>(0, Names::listCompResult);
-        else
-            emit<Instr_GetStackLocal>(Names::listCompResult, 0);
+        emit<Instr_GetStackLocal>(Names::listCompResult, 0);
         compile(*s.expr);
         emit<Instr_ListAppend>();
     }
@@ -7,6 +7,7 @@
 #include "numeric.h"
 #include "repr.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 GlobalRoot<Class*> Dict::ObjectClass;
@@ -34,9 +35,9 @@ static bool dict_getitem(NativeArgs args,
                          MutableTraced<Value> resultOut)
 {
     Stack<T*> dict(args[0].as<T>());;
-
-    if (!dict->getitem(args[1], resultOut))
-        return Raise<KeyError>(repr(args[1]), resultOut);
+    Stack<Value> key(args[1]);
+    if (!dict->getitem(key, resultOut))
+        return Raise<KeyError>(repr(key.get()), resultOut);
 
     return true;
 }
@@ -73,6 +74,25 @@ static bool dict_values(NativeArgs args, MutableTraced<Value> resultOut)
     return true;
 }
 
+template <typename T>
+static bool dict_iter(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    // Iterate over a snapshot of the keys of an object's slots.
+    Stack<T*> dict(args[0].as<T>());
+    Stack<Value> keys(dict->keys());
+    Stack<Tuple*> tuple(keys.as<Tuple>());
+    resultOut = gc.create<TupleIter>(tuple);
+    return true;
+}
+
+template <>
+bool dict_iter<Dict>(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Dict*> dict(args[0].as<Dict>());
+    resultOut = gc.create<DictIter>(dict);
+    return true;
+}
+
 template <typename T>
 static void DictInit(const char* name)
 {
@@ -83,6 +103,7 @@ static void DictInit(const char* name)
     initNativeMethod(T::ObjectClass, "__setitem__", dict_setitem<T>, 3);
     initNativeMethod(T::ObjectClass, "__delitem__", dict_delitem<T>, 2);
     initNativeMethod(T::ObjectClass, "keys", dict_keys<T>, 1);
+    initNativeMethod(T::ObjectClass, "__iter__", dict_iter<T>, 1);
     initNativeMethod(T::ObjectClass, "values", dict_values<T>, 1);
     // __eq__ and __ne__ are supplied by internals/internal.py
 }
@@ -90,6 +111,7 @@ static void DictInit(const char* name)
 void Dict::init()
 {
     DictInit<Dict>("dict");
+    DictIter::init("dict_keyiterator");
 }
 
 Dict::Dict()
@@ -97,11 +119,12 @@ Dict::Dict()
 {}
 
 Dict::Dict(const TracedVector<Value>& values)
-  : Object(ObjectClass), entries_(values.size() / 2)
+  : Object(ObjectClass)
 {
     unsigned entryCount = values.size() / 2;
+    table_ = DictTable::get(entryCount);
     for (unsigned i = 0; i < entryCount; ++i)
-        entries_[values[i * 2]] = values[i * 2 + 1];
+        setitem(values[i * 2], values[i * 2 + 1]);
 }
 
 Dict::Dict(Traced<Class*> cls)
@@ -113,76 +136,99 @@ Dict::Dict(Traced<Class*> cls)
 void Dict::traceChildren(Tracer& t)
 {
     Object::traceChildren(t);
-    for (auto i = entries_.begin(); i != entries_.end(); ++i) {
-        Value key = i->first;
-#ifdef DEBUG
-        Value prior = key;
-#endif
-        gc.traceUnbarriered(t, &key);
-        assert(key == prior);
-        gc.trace(t, &i->second);
-    }
+    gc.trace(t, &table_);
 }
 
 void Dict::print(ostream& s) const
 {
     s << "{";
-    for (auto i = entries_.begin(); i != entries_.end(); ++i) {
-        if (i != entries_.begin())
+    bool first = true;
+    for (const auto& i : entries()) {
+        if (!first)
             s << ", ";
-        s << i->first << ": " << i->second;
+        s << i.key.get() << ": " << i.value.get();
+        first = false;
     }
     s << "}";
 }
 
-bool Dict::getitem(Traced<Value> key, MutableTraced<Value> resultOut) const
+bool Dict::contains(Traced<Value> keyArg) const
+{
+    // Hashing and comparing keys can run code that reallocates the
+    // interpreter stack, which may be where the arguments live.
+    Stack<Value> key(keyArg);
+    return DictTable::find(table_, key, ValueHash()(key)) != DictTable::NotFound;
+}
+
+bool Dict::getitem(Traced<Value> keyArg, MutableTraced<Value> resultOut) const
 {
-    auto i = entries_.find(key);
-    if (i == entries_.end())
+    Stack<Value> key(keyArg);
+    int32_t e = DictTable::find(table_, key, ValueHash()(key));
+    if (e == DictTable::NotFound)
         return false;
 
-    resultOut = i->second;
+    resultOut = table_->entry(e).value;
     return true;
 }
 
-void Dict::setitem(Traced<Value> key, Traced<Value> value)
+void Dict::setitem(Traced<Value> keyArg, Traced<Value> valueArg)
+{
+    Stack<Value> key(keyArg);
+    Stack<Value> value(valueArg);
+    size_t hash = ValueHash()(key);
+    int32_t e = DictTable::find(table_, key, hash);
+    if (e != DictTable::NotFound) {
+        table_->entry(e).value = value;
+        return;
+    }
+
+    if (!table_ || table_->isFull())
+        grow();
+    table_->append(hash, key).value = value;
+}
+
+void Dict::grow()
 {
-    entries_[key] = value;
+    // Rebuild the table using the stored hashes, dropping deleted entries.
+    size_t count = len();
+    size_t capacity = max(count * 2, count + 1);
+    table_ = table_ ? table_->rebuild(capacity) : DictTable::get(capacity);
 }
 
-bool Dict::delitem(Traced<Value> key, MutableTraced<Value> resultOut)
+bool Dict::delitem(Traced<Value> keyArg, MutableTraced<Value> resultOut)
 {
-    auto i = entries_.find(key);
-    if (i == entries_.end())
-        return Raise<KeyError>(repr(key), resultOut);
+    Stack<Value> key(keyArg);
+    int32_t e = DictTable::find(table_, key, ValueHash()(key));
+    if (e == DictTable::NotFound)
+        return Raise<KeyError>(repr(key.get()), resultOut);
 
-    entries_.erase(i);
+    table_->remove(e);
     resultOut = None;
     return true;
 }
 
 void Dict::clear()
 {
-    entries_.clear();
+    table_ = nullptr;
 }
 
 Value Dict::keys() const
 {
     // todo: should be some kind of iterator?
-    Stack<Tuple*> keys(Tuple::getUninitialised(entries_.size()));
+    Stack<Tuple*> keys(Tuple::getUninitialised(len()));
     size_t index = 0;
-    for (const auto& i : entries_)
-        keys->initElement(index++, i.first);
+    for (const auto& i : entries())
+        keys->initElement(index++, i.key);
     return Value(keys);
 }
 
 Value Dict::values() const
 {
     // todo: should be some kind of iterator?
-    Stack<Tuple*> values(Tuple::getUninitialised(entries_.size()));
+    Stack<Tuple*> values(Tuple::getUninitialised(len()));
     size_t index = 0;
-    for (const auto& i : entries_)
-        values->initElement(index++, i.second);
+    for (const auto& i : entries())
+        values->initElement(index++, i.value);
     return Value(values);
 }
 
@@ -220,7 +266,13 @@ void DictView::checkMap() const
 
 size_t DictView::len() const
 {
-    return object_->layout()->slotCount();
+    // Objects may have uninitialised slots if their layout was preallocated.
+    size_t count = 0;
+    for (size_t i = 0; i < object_->layout()->slotCount(); i++) {
+        if (object_->hasSlot(i))
+            count++;
+    }
+    return count;
 }
 
 int DictView::findSlot(Traced<Value> key) const
@@ -238,12 +290,19 @@ int DictView::findSlot(Traced<Value> key) const
 int DictView::findSlot(Name name) const
 {
     checkMap();
+    int slot;
     auto i = slots_.find(name);
-    if (i != slots_.end())
-        return i->second;
+    if (i != slots_.end()) {
+        slot = i->second;
+    } else {
+        slot = object_->layout()->lookupName(name);
+        slots_[name] = slot;
+    }
+
+    // The slot may be present in the layout but not yet initialised.
+    if (slot != Layout::NotFound && !object_->hasSlot(slot))
+        return Layout::NotFound;
 
-    int slot = object_->findOwnAttr(name);
-    slots_[name] = slot;
     return slot;
 }
 
@@ -298,7 +357,8 @@ Value DictView::keys() const
     Stack<Layout*> layout(object_->layout());
     size_t index = 0;
     while (layout != Layout::Empty) {
-        keys->initElement(index++, layout->name());
+        if (object_->hasSlot(layout->slotIndex()))
+            keys->initElement(index++, layout->name());
         layout = layout->parent();
     }
     return Value(keys);
@@ -308,7 +368,10 @@ Value DictView::values() const
 {
     // todo: should be some kind of iterator?
     Stack<Tuple*> values(Tuple::getUninitialised(len()));
-    for (size_t index = 0; index < len(); index++)
-        values->initElement(index, object_->getSlot(index));
+    size_t index = 0;
+    for (size_t i = 0; i < object_->layout()->slotCount(); i++) {
+        if (object_->hasSlot(i))
+            values->initElement(index++, object_->getSlot(i));
+    }
     return Value(values);
 }
@@ -1,10 +1,13 @@
 #ifndef __DICT_H__
 #define __DICT_H__
 
+#include "hashtable.h"
 #include "object.h"
 
 #include <unordered_map>
 
+using DictTable = HashTable<DictEntry>;
+
 struct Dict : public Object
 {
     static void init();
@@ -19,13 +22,10 @@ struct Dict : public Object
     void print(ostream& s) const override;
 
     size_t len() const {
-        return entries_.size();
-    }
-
-    bool contains(Traced<Value> key) const {
-        return entries_.find(key) != entries_.end();
+        return table_ ? table_->count() : 0;
     }
 
+    bool contains(Traced<Value> key) const;
     bool getitem(Traced<Value> key, MutableTraced<Value> resultOut) const;
     void setitem(Traced<Value> key, Traced<Value> value);
     bool delitem(Traced<Value> key, MutableTraced<Value> resultOut);
@@ -33,12 +33,16 @@ struct Dict : public Object
     Value keys() const;
     Value values() const;
 
+    // The live entries in insertion order.  The dict must not be modified
+    // while these are being iterated.
+    DictTable::Entries entries() const { return DictTable::Entries(table_); }
+
+    DictTable* table() const { return table_; }
+
   private:
-    using Map = unordered_map<Value, Heap<Value>, ValueHash, ValuesEqual>;
-    Map entries_;
+    Heap<DictTable*> table_;
 
-  public:
-    const Map& entries() { return entries_; }
+    void grow();
 };
 
 // An adaptor to access the slots of an object as a dict.
@@ -75,4 +79,7 @@ struct DictView : public Object
     int findSlot(Name Name) const;
 };
 
+extern template struct KeyIterImpl<Dict>;
+typedef KeyIterImpl<Dict> DictIter;
+
 #endif
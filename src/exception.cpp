@@ -1,5 +1,6 @@
 #include "exception.h"
 
+#include "block.h"
 #include "callable.h"
 #include "instr.h"
 #include "interp.h"
@@ -57,7 +58,7 @@ void Exception::init()
 }
 
 Exception::Exception(Traced<Class*> cls, const string& message)
-  : Object(cls)
+  : Object(cls), tracebackDepth_(0)
 {
     assert(cls->isDerivedFrom(ObjectClass));
     Stack<String*> str(String::get(message));
@@ -65,7 +66,7 @@ Exception::Exception(Traced<Class*> cls, const string& message)
 }
 
 Exception::Exception(Traced<Class*> cls, Traced<String*> message)
-  : Object(cls)
+  : Object(cls), tracebackDepth_(0)
 {
     assert(cls->isDerivedFrom(ObjectClass));
     init(message);
@@ -73,7 +74,8 @@ Exception::Exception(Traced<Class*> cls, Traced<String*> message)
 
 void Exception::init(Traced<String*> message)
 {
-    maybeAbortTests(className() + " " + message->value());
+    if (testsMayAbort())
+        maybeAbortTests(className() + " " + message->value());
     setAttr(Names::message, message);
 }
 
@@ -103,7 +105,8 @@ string Exception::traceback() const
     ostringstream s;
     s << "Traceback (most recent call last):" << endl;
     for (size_t i = traceback_.size(); i != 0; i--) {
-        TokenPos pos = traceback_[i - 1];
+        const TracebackEntry& entry = traceback_[i - 1];
+        TokenPos pos = entry.block->getPos(entry.instrp);
         if (pos.file != "" || pos.line != 0) {
             s << "  File \"" << pos.file << "\", ";
             s << "line " << pos.line << endl;
@@ -117,17 +120,28 @@ void Exception::print(ostream& s) const
     s << fullMessage();
 }
 
-void Exception::recordTraceback(const InstrThunk* instrp)
+void Exception::traceChildren(Tracer& t)
 {
-    assert(traceback_.empty());
-    size_t count = interp->frameCount();
-    traceback_.reserve(count);
-    for (size_t i = 0; i < count; i++) {
-        Frame* frame = interp->getFrame(i);
-        if (instrp)
-            traceback_.push_back(frame->block()->getPos(instrp));
-        instrp = frame->returnPoint();
-    }
+    Object::traceChildren(t);
+    for (auto& entry : traceback_)
+        gc.traceUnbarriered(t, &entry.block);
+}
+
+void Exception::recordTraceback(Block* block, const InstrThunk* instrp,
+                                size_t depth)
+{
+    // The shared StopIteration instance is only used for control flow.
+    if (this == StopIterationException)
+        return;
+
+    // Once we have a traceback only extend it as the exception propagates to
+    // outer frames, so that re-raising it doesn't record anything again.
+    if (!traceback_.empty() && depth >= tracebackDepth_)
+        return;
+
+    assert(block->contains(instrp));
+    traceback_.push_back({block, instrp});
+    tracebackDepth_ = depth;
 }
 
 void printBacktrace()
@@ -6,6 +6,7 @@
 #include "string.h"
 #include "token.h"
 
+struct Block;
 struct InstrThunk;
 
 struct Exception : public Object
@@ -17,7 +18,11 @@ struct Exception : public Object
     Exception(Traced<Class*> cls, Traced<String*> message);
 
     bool hasTraceback() const { return !traceback_.empty(); }
-    void recordTraceback(const InstrThunk *instrp);
+
+    // Record that the exception passed through |instrp| in |block| on its way
+    // up the stack at frame depth |depth|.  Source positions are only looked up
+    // if the traceback is printed.
+    void recordTraceback(Block* block, const InstrThunk* instrp, size_t depth);
 
     string className() const;
     string message() const;
@@ -26,9 +31,17 @@ struct Exception : public Object
     string traceback() const;
 
     void print(ostream& s) const override;
+    void traceChildren(Tracer& t) override;
 
   private:
-    vector<TokenPos> traceback_;
+    struct TracebackEntry
+    {
+        Block* block;
+        const InstrThunk* instrp;
+    };
+
+    vector<TracebackEntry> traceback_;
+    size_t tracebackDepth_;
 
     void init(Traced<String*> message);
 };
@@ -43,6 +56,7 @@ struct Exception : public Object
     cls(NameError)                                                            \
     cls(NotImplementedError)                                                  \
     cls(OSError)                                                              \
+    cls(RecursionError)                                                       \
     cls(RuntimeError)                                                         \
     cls(StopIteration)                                                        \
     cls(SyntaxError)                                                          \
@@ -277,7 +277,7 @@ bool File::read(size_t size, MutableTraced<Value> resultOut)
     if (!checkError("Read error", resultOut))
         return false;
 
-    resultOut = gc.create<String>(result);
+    resultOut = String::get(result);
     return true;
 }
 
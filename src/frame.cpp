@@ -29,8 +29,7 @@ Frame::Frame()
   : block_(nullptr),
     env_(nullptr),
     returnPoint_(nullptr),
-    stackPos_(0),
-    exceptionHandlers_(nullptr)
+    stackPos_(0)
 {}
 
 Frame::Frame(InstrThunk* returnPoint, Traced<Block*> block, unsigned stackPos,
@@ -39,42 +38,13 @@ Frame::Frame(InstrThunk* returnPoint, Traced<Block*> block, unsigned stackPos,
     env_(nullptr),
     returnPoint_(returnPoint),
     stackPos_(stackPos),
-    extraPopCount_(extraPopCount),
-    exceptionHandlers_(nullptr)
+    extraPopCount_(extraPopCount)
 {}
 
-void Frame::pushHandler(Traced<ExceptionHandler*> eh)
-{
-    eh->setNext(exceptionHandlers_);
-    exceptionHandlers_ = eh;
-}
-
-ExceptionHandler* Frame::popHandler()
-{
-    assert(exceptionHandlers_);
-    ExceptionHandler* eh = exceptionHandlers_;
-    exceptionHandlers_ = eh->next();
-    return eh;
-}
-
-void Frame::setHandlers(Traced<ExceptionHandler*> ehs)
-{
-    assert(!exceptionHandlers_);
-    exceptionHandlers_ = ehs;
-}
-
-ExceptionHandler* Frame::takeHandlers()
-{
-    ExceptionHandler* ehs = exceptionHandlers_;
-    exceptionHandlers_ = nullptr;
-    return ehs;
-}
-
 void Frame::traceChildren(Tracer& t)
 {
     gc.trace(t, &block_);
     gc.trace(t, &env_);
-    gc.trace(t, &exceptionHandlers_);
 }
 
 void GCTraits<Frame>::trace(Tracer& t, Frame* frame)
@@ -89,7 +59,5 @@ void GCTraits<Frame>::checkValid(const Frame& frame)
         frame.block()->checkValid();
     if (frame.env())
         frame.env()->checkValid();
-    if (frame.exceptionHandlers())
-        frame.exceptionHandlers()->checkValid();
 }
 #endif
@@ -4,7 +4,6 @@
 #include "object.h"
 
 struct Block;
-struct ExceptionHandler;
 struct InstrThunk;
 struct Interpreter;
 
@@ -44,13 +43,6 @@ struct Frame
     InstrThunk* returnPoint() const { return returnPoint_; }
     unsigned stackPos() const { return stackPos_; }
     unsigned extraPopCount() const { return extraPopCount_; }
-    ExceptionHandler* exceptionHandlers() const { return exceptionHandlers_; }
-
-    void pushHandler(Traced<ExceptionHandler*> eh);
-    ExceptionHandler* popHandler();
-
-    void setHandlers(Traced<ExceptionHandler*> ehs);
-    ExceptionHandler* takeHandlers();
 
     void traceChildren(Tracer& t);
 
@@ -60,7 +52,6 @@ struct Frame
     InstrThunk* returnPoint_;
     unsigned stackPos_;
     unsigned extraPopCount_;
-    Heap<ExceptionHandler*> exceptionHandlers_;
 };
 
 #endif
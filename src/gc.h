@@ -56,6 +56,9 @@ struct GC
     template <typename T, typename... Args>
     inline T* createSized(size_t size, Args&&... args);
 
+    // Get the number of bytes actually allocated for a cell of a given size.
+    static inline size_t allocatedSize(size_t size);
+
     void collect();
 
     template <typename T>
@@ -1004,6 +1007,11 @@ size_t GC::sizeFromClass(SizeClass sc)
     return 1u << (sc - smallSizeClassCount + sizeLargeThresholdShift);
 }
 
+size_t GC::allocatedSize(size_t size)
+{
+    return sizeFromClass(sizeClass(size));
+}
+
 inline void GC::maybeCollect()
 {
     assert(unsafeCount == 0);
@@ -50,9 +50,9 @@ GeneratorIter::GeneratorIter(Traced<Block*> block,
                              unsigned argCount)
   : Object(ObjectClass),
     state_(Running),
+    resumedByLoop_(false),
     block_(block),
     env_(env),
-    exceptionHandlers_(nullptr),
     ipOffset_(0),
     argCount_(argCount)
 {
@@ -64,7 +64,6 @@ void GeneratorIter::traceChildren(Tracer& t)
     Object::traceChildren(t);
     gc.trace(t, &block_);
     gc.trace(t, &env_);
-    gc.trace(t, &exceptionHandlers_);
     gc.traceVector(t, &savedStack_);
 }
 
@@ -75,15 +74,14 @@ bool GeneratorIter::iter(MutableTraced<Value> resultOut)
     return true;
 }
 
-void GeneratorIter::resume(Interpreter& interp)
+void GeneratorIter::resume(Interpreter& interp, bool forLoop)
 {
     log("GeneratorIter::resume", this, state_);
     switch (state_) {
       case Suspended: {
-        interp.resumeGenerator(block_, env_, ipOffset_, savedStack_,
-                               exceptionHandlers_);
+        resumedByLoop_ = forLoop;
+        interp.resumeGenerator(block_, env_, ipOffset_, savedStack_);
         savedStack_.resize(0);
-        exceptionHandlers_ = nullptr;
         if (state_ == Suspended)
             interp.pushStack(None);
         state_ = Running;
@@ -96,11 +94,16 @@ void GeneratorIter::resume(Interpreter& interp)
         interp.raise<ValueError>("Generator running");
         break;
 
-      case Finished:
+      case Finished: {
         assert(savedStack_.empty());
-        // todo: not sure about this behaviour, need tests
-        interp.raise<StopIteration>();
+        if (forLoop) {
+            interp.pushStack(None, Boolean::get(false));
+            break;
+        }
+        Stack<Value> exception(StopIterationException);
+        interp.raiseException(exception);
         break;
+      }
 
       default:
         assert(false);
@@ -115,7 +118,11 @@ void GeneratorIter::leave(Interpreter& interp)
     assert(savedStack_.empty());
     interp.popFrame();
     state_ = Finished;
-    Stack<Value> exception(gc.create<StopIteration>());
+    if (resumedByLoop_) {
+        interp.pushStack(None, Boolean::get(false));
+        return;
+    }
+    Stack<Value> exception(StopIterationException);
     interp.raiseException(exception);
 }
 
@@ -124,9 +131,10 @@ void GeneratorIter::suspend(Interpreter& interp, Traced<Value> value)
     log("GeneratorIter::suspend", this, state_);
     assert(state_ == Running);
     assert(savedStack_.empty());
-    Stack<ExceptionHandler*> ehs;
-    ipOffset_ = interp.suspendGenerator(savedStack_, ehs);
-    exceptionHandlers_ = ehs;
+    ipOffset_ = interp.suspendGenerator(savedStack_);
     state_ = Suspended;
-    interp.pushStack(value);
+    if (resumedByLoop_)
+        interp.pushStack(value, Boolean::get(true));
+    else
+        interp.pushStack(value);
 }
@@ -4,7 +4,6 @@
 #include "object.h"
 #include "callable.h"
 
-struct ExceptionHandler;
 struct Interpreter;
 
 struct GeneratorIter : public Object
@@ -19,7 +18,11 @@ struct GeneratorIter : public Object
     bool iter(MutableTraced<Value> resultOut);
     bool next(MutableTraced<Value> resultOut);
 
-    void resume(Interpreter& interp);
+    // Resume the generator.  If |forLoop| is set the generator was resumed
+    // directly by a for loop's IteratorNext, so rather than raising
+    // StopIteration on exhaustion it leaves a value and a boolean indicating
+    // whether iteration should continue on the stack.
+    void resume(Interpreter& interp, bool forLoop = false);
     void leave(Interpreter& interp);
     void suspend(Interpreter& interp, Traced<Value> value);
 
@@ -33,9 +36,9 @@ struct GeneratorIter : public Object
 
     // todo: does it make sense to embed a Frame here?
     State state_;
+    bool resumedByLoop_;
     Heap<Block*> block_;
     Heap<Env*> env_;
-    Heap<ExceptionHandler*> exceptionHandlers_;
     size_t ipOffset_;
     unsigned argCount_;
     HeapVector<Value> savedStack_;
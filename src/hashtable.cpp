@@ -0,0 +1,115 @@
+#include "hashtable.h"
+
+#include "callable.h"
+#include "dict.h"
+#include "exception.h"
+#include "set.h"
+
+#include "value-inl.h"
+
+void DictEntry::traceChildren(Tracer& t)
+{
+    gc.trace(t, &key);
+    gc.trace(t, &value);
+}
+
+void SetEntry::traceChildren(Tracer& t)
+{
+    gc.trace(t, &key);
+}
+
+template <typename T>
+GlobalRoot<Class*> KeyIterImpl<T>::ObjectClass;
+
+template struct KeyIterImpl<Dict>;
+template struct KeyIterImpl<Set>;
+
+static const char* ContainerName(Dict* dict)
+{
+    return "dictionary";
+}
+
+static const char* ContainerName(Set* set)
+{
+    return "Set";
+}
+
+template <typename T>
+KeyIterImpl<T>::KeyIterImpl(Traced<T*> container)
+  : Object(ObjectClass),
+    container_(container),
+    index_(0),
+    count_(container->len()),
+    remaining_(count_)
+{}
+
+template <typename T>
+void KeyIterImpl<T>::traceChildren(Tracer& t)
+{
+    Object::traceChildren(t);
+    gc.trace(t, &container_);
+}
+
+template <typename T>
+bool KeyIterImpl<T>::next(MutableTraced<Value> resultOut)
+{
+    if (!container_) {
+        resultOut = StopIterationException;
+        return false;
+    }
+
+    T* container = container_;
+    if (container->len() != count_) {
+        container_ = nullptr;
+        string message = string(ContainerName(container)) +
+                         " changed size during iteration";
+        return Raise<RuntimeError>(message, resultOut);
+    }
+
+    auto table = container->table();
+    while (table && index_ < table->used() &&
+           table->entry(index_).isDeleted())
+    {
+        index_++;
+    }
+
+    if (!table || index_ == table->used()) {
+        container_ = nullptr;
+        resultOut = StopIterationException;
+        return false;
+    }
+
+    // The size is unchanged but entries were both added and removed.
+    if (remaining_ == 0) {
+        container_ = nullptr;
+        string message = string(ContainerName(container)) +
+                         " keys changed during iteration";
+        return Raise<RuntimeError>(message, resultOut);
+    }
+
+    resultOut = table->entry(index_).key;
+    index_++;
+    remaining_--;
+    return true;
+}
+
+template <typename T>
+static bool keyIter_iter(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    resultOut = args[0];
+    return true;
+}
+
+template <typename T>
+static bool keyIter_next(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    return args[0].as<KeyIterImpl<T>>()->next(resultOut);
+}
+
+template <typename T>
+/* static */ void KeyIterImpl<T>::init(const char* name)
+{
+    ObjectClass.init(Class::createNative(name, nullptr));
+    initNativeMethod(ObjectClass, "__iter__", keyIter_iter<T>, 1);
+    initNativeMethod(ObjectClass, "__next__", keyIter_next<T>, 1);
+}
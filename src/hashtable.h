@@ -0,0 +1,300 @@
+#ifndef __HASHTABLE_H__
+#define __HASHTABLE_H__
+
+#include "gc.h"
+#include "object.h"
+#include "value.h"
+
+// Entry types for HashTable.  A deleted entry has a null key.
+struct DictEntry
+{
+    size_t hash;
+    Heap<Value> key;
+    Heap<Value> value;
+
+    bool isDeleted() const { return key.get() == Value(); }
+    void clear() {
+        key = Value();
+        value = Value();
+    }
+    void traceChildren(Tracer& t);
+};
+
+struct SetEntry
+{
+    size_t hash;
+    Heap<Value> key;
+
+    bool isDeleted() const { return key.get() == Value(); }
+    void clear() { key = Value(); }
+    void traceChildren(Tracer& t);
+};
+
+// Storage for dict and set entries.
+//
+// Entries are stored densely in insertion order together with their hash
+// codes.  A separate open addressing index maps hash codes to entry positions.
+// Deleting an entry clears its key but leaves it in place so that probe
+// sequences are not broken; deleted entries are compacted away the next time
+// the table is rebuilt.
+template <typename E>
+struct HashTable : public Cell
+{
+    using Entry = E;
+
+    static const int32_t NotFound = -1;
+
+    static HashTable* get(size_t minCapacity);
+
+    // Create a new table with space for at least minCapacity entries
+    // containing the live entries of this one.
+    HashTable* rebuild(size_t minCapacity);
+
+    // Find the position of the entry for key in the table referenced by
+    // tableRef, or NotFound.  Comparing keys may run arbitrary code which can
+    // replace or modify the table, in which case the search is restarted.
+    static int32_t find(const Heap<HashTable*>& tableRef, Traced<Value> key,
+                        size_t hash);
+
+    void traceChildren(Tracer& t) override;
+
+    size_t count() const { return count_; }
+    size_t used() const { return used_; }
+    size_t capacity() const { return capacity_; }
+    bool isFull() const { return used_ == capacity_; }
+
+    Entry& entry(size_t i) {
+        assert(i < used_);
+        return entries_[i];
+    }
+
+    // Add an entry, which must not already be present.  There must be space.
+    Entry& append(size_t hash, Value key);
+
+    void remove(size_t i) {
+        assert(!entry(i).isDeleted());
+        entry(i).clear();
+        count_--;
+    }
+
+    // Iterate over the live entries in insertion order.
+    struct Iterator
+    {
+        Iterator(HashTable* table, size_t i) : table_(table), i_(i) {
+            skipDeleted();
+        }
+
+        const Entry& operator*() const { return table_->entries_[i_]; }
+        const Entry* operator->() const { return &table_->entries_[i_]; }
+        bool operator!=(const Iterator& other) const { return i_ != other.i_; }
+        Iterator& operator++() {
+            i_++;
+            skipDeleted();
+            return *this;
+        }
+
+      private:
+        HashTable* table_;
+        size_t i_;
+
+        void skipDeleted() {
+            while (table_ && i_ < table_->used_ &&
+                   table_->entries_[i_].isDeleted())
+            {
+                i_++;
+            }
+        }
+    };
+
+    // A range over the live entries of a possibly null table.  The table must
+    // not be modified while this is being iterated.
+    struct Entries
+    {
+        Entries(HashTable* table) : table_(table) {}
+        Iterator begin() const { return Iterator(table_, 0); }
+        Iterator end() const {
+            return Iterator(table_, table_ ? table_->used_ : 0);
+        }
+
+      private:
+        HashTable* table_;
+    };
+
+  private:
+    friend struct GC;
+
+    static const int32_t EmptySlot = -1;
+    static const size_t MinIndexSize = 8;
+
+    HashTable(size_t capacity, size_t indexSize);
+
+    static size_t indexSizeFor(size_t minCapacity);
+
+    int32_t* index() {
+        return reinterpret_cast<int32_t*>(&entries_[capacity_]);
+    }
+
+    size_t indexMask() const { return indexSize_ - 1; }
+
+    static size_t nextProbe(size_t i, size_t& perturb, size_t mask) {
+        perturb >>= 5;
+        return (i * 5 + perturb + 1) & mask;
+    }
+
+    uint32_t count_;
+    uint32_t used_;
+    uint32_t capacity_;
+    uint32_t indexSize_;
+    Entry entries_[0];
+};
+
+template <typename E>
+/* static */ size_t HashTable<E>::indexSizeFor(size_t minCapacity)
+{
+    // Keep the index at most two thirds full.
+    size_t size = MinIndexSize;
+    while (size * 2 / 3 < minCapacity)
+        size *= 2;
+    return size;
+}
+
+template <typename E>
+/* static */ HashTable<E>* HashTable<E>::get(size_t minCapacity)
+{
+    size_t indexSize = indexSizeFor(minCapacity);
+    size_t capacity = indexSize * 2 / 3;
+    size_t size = sizeof(HashTable) + capacity * sizeof(Entry) +
+                  indexSize * sizeof(int32_t);
+    return gc.createSized<HashTable>(size, capacity, indexSize);
+}
+
+template <typename E>
+HashTable<E>::HashTable(size_t capacity, size_t indexSize)
+  : count_(0), used_(0), capacity_(capacity), indexSize_(indexSize)
+{
+    assert(capacity < indexSize);
+    assert((indexSize & (indexSize - 1)) == 0);
+    int32_t* slots = index();
+    for (size_t i = 0; i < indexSize; i++)
+        slots[i] = EmptySlot;
+}
+
+template <typename E>
+HashTable<E>* HashTable<E>::rebuild(size_t minCapacity)
+{
+    assert(minCapacity >= count_);
+    Stack<HashTable*> self(this);
+    HashTable* table = get(minCapacity);
+    for (size_t i = 0; i < used_; i++) {
+        Entry& entry = entries_[i];
+        if (!entry.isDeleted()) {
+            Entry& copy = table->append(entry.hash, entry.key);
+            copy = entry;
+        }
+    }
+    return table;
+}
+
+template <typename E>
+void HashTable<E>::traceChildren(Tracer& t)
+{
+    for (size_t i = 0; i < used_; i++) {
+        Entry& entry = entries_[i];
+        if (!entry.isDeleted())
+            entry.traceChildren(t);
+    }
+}
+
+template <typename E>
+E& HashTable<E>::append(size_t hash, Value key)
+{
+    assert(!isFull());
+    int32_t* slots = index();
+    size_t mask = indexMask();
+    size_t i = hash & mask;
+    size_t perturb = hash;
+    while (slots[i] != EmptySlot)
+        i = nextProbe(i, perturb, mask);
+
+    Entry* entry = new (&entries_[used_]) Entry;
+    entry->hash = hash;
+    entry->key = key;
+    slots[i] = used_;
+    used_++;
+    count_++;
+    return *entry;
+}
+
+template <typename E>
+/* static */ int32_t HashTable<E>::find(const Heap<HashTable*>& tableRef,
+                                        Traced<Value> key, size_t hash)
+{
+    for (;;) {
+        HashTable* table = tableRef;
+        if (!table)
+            return NotFound;
+
+        int32_t* slots = table->index();
+        size_t mask = table->indexMask();
+        size_t i = hash & mask;
+        size_t perturb = hash;
+        bool restart = false;
+        while (!restart) {
+            int32_t e = slots[i];
+            if (e == EmptySlot)
+                return NotFound;
+
+            Entry& entry = table->entries_[e];
+            if (entry.hash == hash && !entry.isDeleted()) {
+                Value k = entry.key;
+                if (k == key.get())
+                    return e;
+
+                bool equal;
+                if (MaybeCompareBuiltins(k, key, equal)) {
+                    if (equal)
+                        return e;
+                } else {
+                    Stack<HashTable*> root(table);
+                    Stack<Value> entryKey(k);
+                    equal = ValuesEqual()(entryKey, key);
+                    if (tableRef.get() != table ||
+                        table->entries_[e].key.get() != entryKey.get())
+                    {
+                        restart = true;
+                    } else if (equal) {
+                        return e;
+                    }
+                }
+            }
+
+            i = nextProbe(i, perturb, mask);
+        }
+    }
+}
+
+// An iterator over the keys of a dict or set in insertion order.
+//
+// Entries are visited by position in the container's current table.  As in
+// CPython, changing the number of entries during iteration raises
+// RuntimeError.
+template <typename T>
+struct KeyIterImpl : public Object
+{
+    static void init(const char* name);
+    static GlobalRoot<Class*> ObjectClass;
+
+    KeyIterImpl(Traced<T*> container);
+
+    void traceChildren(Tracer& t) override;
+
+    bool next(MutableTraced<Value> resultOut);
+
+  private:
+    Heap<T*> container_;  // Null when finished.
+    size_t index_;
+    size_t count_;
+    size_t remaining_;
+};
+
+#endif
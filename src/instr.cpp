@@ -9,7 +9,9 @@
 #include "singletons.h"
 #include "slice.h"
 #include "list.h"
+#include "range.h"
 #include "set.h"
+#include "string.h"
 #include "utils.h"
 
 InstrType instrType(InstrCode code)
@@ -96,6 +98,12 @@ void LexicalFrameInstr::print(ostream& s) const
     s << " " << frameIndex << " " << ident;
 }
 
+void LexicalSlotInstr::print(ostream& s) const
+{
+    Instr::print(s);
+    s << " " << frameIndex << " " << ident << " " << slot;
+}
+
 void CountInstr::print(ostream& s) const
 {
     Instr::print(s);
@@ -112,7 +120,7 @@ void ValueInstr::print(ostream& s) const
 {
     Instr::print(s);
     if (!value_.isObject())
-        s << " " << value_;
+        s << " " << value_.get();
 }
 
 void CallWithFullArgsInstr::print(ostream& s) const
@@ -137,6 +145,20 @@ void CallWithFullArgsInstr::traceChildren(Tracer& t)
 {
     Instr::traceChildren(t);
     gc.trace(t, &keywords);
+    gc.trace(t, &cachedInfo_);
+    gc.trace(t, &cachedKeywords_);
+}
+
+void CallWithFullArgsInstr::setCachedArgSources(Traced<FunctionInfo*> info,
+                                                Traced<Layout*> keywords,
+                                                unsigned argCount,
+                                                vector<int>&& sources)
+{
+    assert(sources.size() == info->argCount());
+    cachedInfo_ = info;
+    cachedKeywords_ = keywords;
+    cachedArgCount_ = argCount;
+    cachedArgSources_ = move(sources);
 }
 
 void BuiltinMethodInstr::traceChildren(Tracer& t)
@@ -291,6 +313,52 @@ Interpreter::executeInstr_DelLexical(Traced<LexicalFrameInstr*> instr)
         raiseNameError(instr->ident);
 }
 
+void
+Interpreter::executeInstr_GetLexicalSlot(Traced<LexicalSlotInstr*> instr)
+{
+    // Name was present when compiled, but may have been deleted.
+    {
+        AutoAssertNoGC nogc;
+        Env* env = lexicalEnv(instr->frameIndex);
+        assert(env);
+
+        if (env->hasSlot(instr->slot)) {
+            pushStack(env->getSlot(instr->slot));
+            return;
+        }
+    }
+
+    raiseNameError(instr->ident);
+}
+
+void
+Interpreter::executeInstr_SetLexicalSlot(Traced<LexicalSlotInstr*> instr)
+{
+    AutoAssertNoGC nogc;
+    Env* env = lexicalEnv(instr->frameIndex);
+    assert(env);
+
+    env->setSlot(instr->slot, peekStack());
+}
+
+void
+Interpreter::executeInstr_DelLexicalSlot(Traced<LexicalSlotInstr*> instr)
+{
+    // Delete by setting slot value to UninitializedSlot.
+    {
+        AutoAssertNoGC nogc;
+        Env* env = lexicalEnv(instr->frameIndex);
+        assert(env);
+
+        if (env->hasSlot(instr->slot)) {
+            env->setSlot(instr->slot, Value(UninitializedSlot));
+            return;
+        }
+    }
+
+    raiseNameError(instr->ident);
+}
+
 void
 Interpreter::executeInstr_GetGlobal(Traced<GlobalNameInstr*> instr)
 {
@@ -412,30 +480,225 @@ size_t CallWithFullArgsInstr::slotCount(Frame* frame, size_t stackPos) const
     return count;
 }
 
+// Push the values of the mapping on the top of the stack and return the layout
+// describing all the keyword arguments, or null if an exception was raised.
 Layout* Interpreter::unpackKeywordMapping(Traced<Layout*> initialKeywords)
 {
     Stack<Layout*> keywords(initialKeywords);
     Stack<Dict*> mapping(popStack().as<Dict>()); // todo: support non-dict mappings
-    for (auto i : mapping->entries()) {
-        Stack<Value> key(i.first);
-        if (!key.is<String>())
+    for (const auto& i : mapping->entries()) {
+        Stack<Value> key(i.key);
+        if (!key.is<String>()) {
             raise<TypeError>("Mapping contains non-string key");
+            return nullptr;
+        }
         Name name = internString(key.as<String>()->value());
         keywords = keywords->addName(name);
-        stack.push_back(i.second);
+        stack.push_back(i.value);
     }
     return keywords;
 }
 
+// Find where each of a function's formal parameters comes from when it is
+// called with |argCount| arguments, the last of which are the keyword arguments
+// named by |keywords|.  Returns false if the call doesn't match the parameters
+// or if the function takes rest or keywords parameters, in which case the call
+// must take the general path.
+static bool FindArgSources(Traced<Function*> function,
+                           Traced<Layout*> keywords,
+                           unsigned argCount,
+                           vector<int>& sourcesOut)
+{
+    if (function->takesRest() || function->takesKeywords())
+        return false;
+
+    size_t keywordCount = keywords->slotCount();
+    assert(keywordCount <= argCount);
+    size_t posCount = argCount - keywordCount;
+    size_t paramCount = function->argCount();
+    if (posCount > paramCount)
+        return false;
+
+    sourcesOut.assign(paramCount, -1);
+    for (size_t i = 0; i < posCount; i++)
+        sourcesOut[i] = i;
+
+    for (Layout* l = keywords; l != Layout::Empty; l = l->parent()) {
+        int argPos = function->findArg(l->name());
+        if (argPos == -1 || sourcesOut[argPos] != -1)
+            return false;
+        sourcesOut[argPos] = posCount + l->slotIndex();
+    }
+
+    size_t firstDefault = function->firstDefaultParam();
+    for (size_t i = posCount; i < firstDefault; i++) {
+        if (sourcesOut[i] == -1)
+            return false;
+    }
+
+    return true;
+}
+
+void Interpreter::startCallWithKeywords(Traced<CallWithFullArgsInstr*> instr,
+                                        Traced<Value> target,
+                                        unsigned argCount,
+                                        Traced<Layout*> keywords,
+                                        unsigned extraPopCount)
+{
+    if (keywords == Layout::Empty || !target.is<Function>()) {
+        startCall(target, argCount, keywords, extraPopCount);
+        return;
+    }
+
+    Stack<Function*> function(target.as<Function>());
+    Stack<FunctionInfo*> info(function->info());
+    if (exceedsRecursionLimit()) {
+        startCall(target, argCount, keywords, extraPopCount);
+        return;
+    }
+    if (!instr->hasCachedArgSources(info, keywords, argCount)) {
+        vector<int> sources;
+        if (!FindArgSources(function, keywords, argCount, sources)) {
+            startCall(target, argCount, keywords, extraPopCount);
+            return;
+        }
+        instr->setCachedArgSources(info, keywords, argCount, move(sources));
+    }
+
+    // Shuffle the arguments into parameter order above the supplied
+    // arguments and then move them down into place.
+    {
+        AutoAssertNoGC nogc;
+        const vector<int>& sources = instr->cachedArgSources();
+        size_t paramCount = sources.size();
+        size_t argsPos = stack.size() - argCount;
+        size_t shufflePos = stack.size();
+        stack.resize(shufflePos + paramCount);
+        for (size_t i = 0; i < paramCount; i++) {
+            int source = sources[i];
+            if (source != -1)
+                stack[shufflePos + i] = stack[argsPos + source];
+            else
+                stack[shufflePos + i] = function->paramDefault(i);
+        }
+        for (size_t i = 0; i < paramCount; i++)
+            stack[argsPos + i] = stack[shufflePos + i];
+        stack.resize(argsPos + paramCount);
+    }
+
+    Stack<Block*> block(function->block());
+    pushFrame(block, stack.size() - function->argCount(), extraPopCount);
+    Stack<Env*> parentEnv(function->env());
+    pushStack(parentEnv);
+}
+
+// Check whether a function's only parameters are a rest parameter and
+// optionally a keywords parameter, e.g. def f(*args, **kwargs).
+static bool TakesOnlyRestAndKeywords(Traced<Function*> function)
+{
+    return function->takesRest() && function->restParam() == 0 &&
+           function->argCount() == (function->takesKeywords() ? 2 : 1);
+}
+
+static bool HasOnlyStringKeys(Traced<Dict*> dict)
+{
+    for (const auto& i : dict->entries()) {
+        if (!i.key.is<String>())
+            return false;
+    }
+    return true;
+}
+
+bool Interpreter::maybeForwardUnpackedArgs(Traced<Value> target,
+                                           Traced<Value> seq,
+                                           Traced<Dict*> mapping,
+                                           unsigned stackCount)
+{
+    // Tuples are immutable so can be passed through as the rest argument.
+    if (!target.is<Function>() || seq.type() != Tuple::ObjectClass)
+        return false;
+
+    Stack<Function*> function(target.as<Function>());
+    if (!TakesOnlyRestAndKeywords(function) || exceedsRecursionLimit())
+        return false;
+
+    if (mapping) {
+        if (!HasOnlyStringKeys(mapping))
+            return false;
+        if (!function->takesKeywords() && mapping->len() != 0)
+            return false;
+    }
+
+    // The callee must get its own keywords dict as it may modify it.
+    Stack<Dict*> keywords;
+    if (function->takesKeywords()) {
+        keywords = gc.create<Dict>();
+        if (mapping) {
+            Stack<Value> key;
+            Stack<Value> value;
+            for (const auto& i : mapping->entries()) {
+                key = i.key;
+                value = i.value;
+                keywords->setitem(key, value);
+            }
+        }
+    }
+
+    popStack(stackCount);
+    pushStack(seq);
+    if (keywords)
+        pushStack(keywords);
+
+    Stack<Block*> block(function->block());
+    pushFrame(block, stack.size() - function->argCount(), 1);
+    Stack<Env*> parentEnv(function->env());
+    pushStack(parentEnv);
+    return true;
+}
+
+void
+Interpreter::executeInstr_CallUnpacked(Traced<CountInstr*> instr)
+{
+    // Call with a single unpacked positional argument and an optional mapping
+    // argument.
+    bool hasMapping = instr->count == 2;
+    Stack<Value> target(peekStack(instr->count));
+    Stack<Value> seq(peekStack(instr->count - 1));
+    Stack<Value> mapping(hasMapping ? peekStack() : Value(None));
+    if (!hasMapping || mapping.is<Dict>()) {
+        Stack<Dict*> dict(hasMapping ? mapping.as<Dict>() : nullptr);
+        if (maybeForwardUnpackedArgs(target, seq, dict, instr->count))
+            return;
+    }
+
+    // Otherwise unpack the arguments onto the stack and make a general call.
+    if (hasMapping)
+        popStack();
+    size_t argsPos = stack.size() - 1;
+    if (!unpackArgs())
+        return;
+    Stack<Layout*> keywords(Layout::Empty);
+    if (hasMapping) {
+        pushStack(mapping);
+        keywords = unpackKeywordMapping(keywords);
+        if (!keywords)
+            return;
+    }
+    startCall(target, stack.size() - argsPos, keywords, 1);
+}
+
 void
 Interpreter::executeInstr_CallWithFullArgs(Traced<CallWithFullArgsInstr*> instr)
 {
     Stack<Layout*> keywords(instr->keywords);
-    if (instr->mappingArg)
+    if (instr->mappingArg) {
         keywords = unpackKeywordMapping(keywords);
+        if (!keywords)
+            return;
+    }
     size_t slotCount = instr->slotCount(getFrame(), stack.size());
     Stack<Value> target(peekStack(slotCount));
-    startCall(target, slotCount, keywords, 1);
+    startCallWithKeywords(instr, target, slotCount, keywords, 1);
 }
 
 /*
@@ -492,13 +755,16 @@ Interpreter::executeInstr_CallMethodWithFullArgs(
     Traced<CallWithFullArgsInstr*> instr)
 {
     Stack<Layout*> keywords(instr->keywords);
-    if (instr->mappingArg)
+    if (instr->mappingArg) {
         keywords = unpackKeywordMapping(keywords);
+        if (!keywords)
+            return;
+    }
     size_t slotCount = instr->slotCount(getFrame(), stack.size());
     bool extraArg = peekStack(slotCount) != Value(UninitializedSlot);
     Stack<Value> target(peekStack(slotCount + 1));
     unsigned posCount = slotCount + (extraArg ? 1 : 0);
-    startCall(target, posCount, keywords, extraArg ? 1 : 2);
+    startCallWithKeywords(instr, target, posCount, keywords, extraArg ? 1 : 2);
 }
 
 void
@@ -510,6 +776,7 @@ Interpreter::executeInstr_CreateEnv(Traced<Instr*> instr)
     Object* obj = popStack().asObject();
     Stack<Env*> parentEnv(obj ? obj->as<Env>() : nullptr);
     Stack<Block*> block(frame->block());
+    assert(block->localsInEnv());
     Stack<Layout*> layout(block->layout());
     Stack<Env*> callEnv(gc.create<Env>(parentEnv, layout));
     unsigned argCount = block->argCount();
@@ -539,9 +806,24 @@ Interpreter::executeInstr_SetEnv(Traced<ValueInstr*> instr)
 void
 Interpreter::executeInstr_InitStackLocals(Traced<CountInstr*> instr)
 {
-    AutoAssertNoGC nogc;
-    assert(!getFrame()->env());
+    Frame* frame = getFrame();
+    assert(!frame->env());
 
+    Block* block = frame->block();
+    if (block->createEnv()) {
+        // Create an environment to hold the locals captured by nested
+        // scopes.  The compiler emits code to copy in any captured arguments.
+        assert(!block->localsInEnv());
+        Object* obj = popStack().asObject();
+        Stack<Env*> parentEnv(obj ? obj->as<Env>() : nullptr);
+        Stack<Layout*> layout(block->envLayout());
+        Stack<Env*> env(gc.create<Env>(parentEnv, layout));
+        setFrameEnv(env);
+        fillStack(instr->count, UninitializedSlot);
+        return;
+    }
+
+    AutoAssertNoGC nogc;
     Object* obj = popStack().asObject();
     Env* parentEnv = obj ? obj->as<Env>() : nullptr;
     setFrameEnv(parentEnv);
@@ -702,7 +984,7 @@ Interpreter::executeInstr_Tuple(Traced<CountInstr*> instr)
 void
 Interpreter::executeInstr_List(Traced<CountInstr*> instr)
 {
-    List* list = gc.create<List>(stackSlice(instr->count));
+    List* list = List::get(stackSlice(instr->count));
     popStack(instr->count);
     pushStack(list);
 }
@@ -731,6 +1013,99 @@ Interpreter::executeInstr_Slice(Traced<Instr*> instr)
     pushStack(slice);
 }
 
+// Whether hashing and comparing a dict key can be done without running user
+// code.
+static bool IsSimpleDictKey(Value key)
+{
+    return key.isInt32() || key.type() == String::ObjectClass;
+}
+
+static InstrCode GetItemStubCode(Value container, Value index)
+{
+    Class* cls = container.type();
+    if (index.isInt32()) {
+        if (cls == List::ObjectClass)
+            return Instr_GetItem_List;
+        if (cls == Tuple::ObjectClass)
+            return Instr_GetItem_Tuple;
+        if (cls == String::ObjectClass)
+            return Instr_GetItem_String;
+    }
+    if (cls == Dict::ObjectClass && IsSimpleDictKey(index))
+        return Instr_GetItem_Dict;
+    return InstrCodeCount;
+}
+
+static InstrCode SetItemStubCode(Value container, Value index)
+{
+    Class* cls = container.type();
+    if (cls == List::ObjectClass && index.isInt32())
+        return Instr_SetItem_List;
+    if (cls == Dict::ObjectClass && IsSimpleDictKey(index))
+        return Instr_SetItem_Dict;
+    return InstrCodeCount;
+}
+
+void
+Interpreter::executeInstr_GetItem(Traced<Instr*> instr)
+{
+    // The stack holds the container and the index.
+    Stack<Value> container(peekStack(1));
+
+    // The builtin container classes cannot be changed, so we can access their
+    // elements directly.
+    if (instr->canAddStub()) {
+        InstrCode code = GetItemStubCode(container, peekStack(0));
+        if (code != InstrCodeCount) {
+            auto stub = gc.create<SubscriptStubInstr>(code, currentInstr());
+            insertStubInstr(instr, stub);
+        }
+    }
+
+    StackMethodAttr method;
+    if (!getSpecialMethodAttr(container, Names::__getitem__, method))
+        return raiseAttrError(container, Names::__getitem__);
+
+    if (!method.isCallable) {
+        swapStack();
+        popStack();
+    }
+    startCall(method.method, 1 + method.extraArgs());
+}
+
+void
+Interpreter::executeInstr_SetItem(Traced<Instr*> instr)
+{
+    // The stack holds the value, the container and the index. The value is
+    // left on the stack.
+    Stack<Value> value(peekStack(2));
+    Stack<Value> container(peekStack(1));
+    Stack<Value> index(peekStack(0));
+
+    if (instr->canAddStub()) {
+        InstrCode code = SetItemStubCode(container, index);
+        if (code != InstrCodeCount) {
+            auto stub = gc.create<SubscriptStubInstr>(code, currentInstr());
+            insertStubInstr(instr, stub);
+        }
+    }
+
+    StackMethodAttr method;
+    if (!getSpecialMethodAttr(container, Names::__setitem__, method))
+        return raiseAttrError(container, Names::__setitem__);
+
+    // Call __setitem__ from a trampoline frame that discards its result.
+    unsigned extraArgs = method.extraArgs();
+    popStack(2);
+    ensureStackSpace(stack.size() + extraArgs + 3);
+    pushStack(method.method);
+    if (method.isCallable)
+        pushStack(container);
+    pushStack(index, value);
+    Stack<Block*> block(SetItemTrampolines[extraArgs]);
+    pushFrame(block, stack.size() - extraArgs - 4, 0);
+}
+
 void
 Interpreter::executeInstr_AssertionFailed(Traced<Instr*> instr)
 {
@@ -868,32 +1243,40 @@ Interpreter::executeInstr_Destructure(Traced<CountInstr*> instr)
         executeDestructureGeneric(count);
 }
 
-void
+bool
 Interpreter::executeUnpackGeneric()
 {
     Stack<Value> result;
-    if (!getIterator(result))
-        return raiseException(result);
+    if (!getIterator(result)) {
+        raiseException(result);
+        return false;
+    }
 
     Stack<Value> iterator(result);
     Stack<Value> type(iterator.type());
     StackMethodAttr nextMethod;
     if (!getMethodAttr(type, Names::__next__, nextMethod)) {
-        return raise<TypeError>(string("Argument is not iterable: ") +
-                                type.as<Class>()->name());
+        raise<TypeError>(string("Argument is not iterable: ") +
+                         type.as<Class>()->name());
+        return false;
     }
 
     for (;;) {
+        // Values pushed so far are not accounted for in the stack depth.
+        ensureStackSpace(stack.size() + 1);
         if (nextMethod.isCallable)
             pushStack(iterator);
         if (!syncCall(nextMethod.method, nextMethod.extraArgs(), result)) {
             if (result.is<StopIteration>())
                 break;
-            return raiseException(result);
+            raiseException(result);
+            return false;
         }
         logStackPush(result);
         stack.push_back(result);
     }
+
+    return true;
 }
 
 template <typename T>
@@ -909,8 +1292,21 @@ Interpreter::executeUnpackBuiltin(T* seq)
     }
 }
 
+template <>
 void
-Interpreter::executeInstr_UnpackArgs(Traced<Instr*> instr)
+Interpreter::executeUnpackBuiltin(Range* range)
+{
+    assert(range->isInt32());
+    popStack();
+
+    for (int64_t i = 0; i < range->len32(); i++) {
+        Value value(range->getitem32(i));
+        logStackPush(value);
+        stack.push_back(value);
+    }
+}
+
+bool Interpreter::unpackArgs()
 {
     Stack<Value> iterable(peekStack());
 
@@ -918,8 +1314,18 @@ Interpreter::executeInstr_UnpackArgs(Traced<Instr*> instr)
         executeUnpackBuiltin<Tuple>(iterable.as<Tuple>());
     else if (iterable.is<List>())
         executeUnpackBuiltin<List>(iterable.as<List>());
+    else if (iterable.is<Range>() && iterable.as<Range>()->isInt32())
+        executeUnpackBuiltin<Range>(iterable.as<Range>());
     else
-        executeUnpackGeneric();
+        return executeUnpackGeneric();
+
+    return true;
+}
+
+void
+Interpreter::executeInstr_UnpackArgs(Traced<Instr*> instr)
+{
+    unpackArgs();
 }
 
 void
@@ -944,14 +1350,112 @@ Interpreter::executeInstr_IteratorNext(Traced<Instr*> instr)
 {
     // The stack is already set up with next method and object instance on top
     Stack<Value> target(peekStack(1));
+    Stack<Value> iterator(peekStack());
     Stack<Value> result;
-    bool ok = call(target, peekStack(), result);
+    bool ok = call(target, iterator, result);
     pushStack(result);
     bool finished = !ok && result.isObject() && result.is<StopIteration>();
     if (!finished && !ok)
         return raiseException();
 
     pushStack(Boolean::get(!finished));
+
+    // Check stub count before attempting to optimise.
+    if (!instr->canAddStub())
+        return;
+
+    // Builtin iterator classes cannot be changed, so we can call their next
+    // method directly.
+    InstrCode code;
+    if (iterator.is<ListIter>())
+        code = Instr_IteratorNext_List;
+    else if (iterator.is<TupleIter>())
+        code = Instr_IteratorNext_Tuple;
+    else if (iterator.is<RangeIter>())
+        code = Instr_IteratorNext_Range;
+    else if (iterator.is<DictIter>())
+        code = Instr_IteratorNext_Dict;
+    else if (iterator.is<SetIter>())
+        code = Instr_IteratorNext_Set;
+    else if (iterator.is<GeneratorIter>())
+        code = Instr_IteratorNext_Generator;
+    else
+        return;
+
+    auto stub = gc.create<IteratorNextStubInstr>(code, currentInstr());
+    insertStubInstr(instr, stub);
+}
+
+void
+Interpreter::executeInstr_GetRangeIterator(Traced<CountInstr*> instr)
+{
+    // Set up the stack for a loop over range(...) with the callee and
+    // arguments on top.  If the callee is the builtin range with int32
+    // arguments, push the loop counter, stop and step values.  Otherwise make
+    // the call and push the iterator's next method, the iterator and None,
+    // which RangeIteratorNext uses to tell the two cases apart.
+    unsigned argc = instr->count;
+    Stack<Value> target(peekStack(argc));
+    int32_t start, stop, step;
+    if (target == Value(Range::ObjectClass) &&
+        Range::getArgs(stackSlice(argc), start, stop, step))
+    {
+        popStack(argc + 1);
+        pushStack(Value(start), Value(stop), Value(step));
+        return;
+    }
+
+    RootVector<Value> args(argc);
+    for (unsigned i = 0; i < argc; i++)
+        args[i] = peekStack(argc - i - 1);
+    popStack(argc + 1);
+
+    Stack<Value> result;
+    if (!syncCall(target, args, result))
+        return raiseException(result);
+
+    pushStack(result);
+    if (!getIterator(result))
+        return raiseException(result);
+
+    Stack<Value> iterator(result);
+    StackMethodAttr method;
+    if (!getMethodAttr(iterator, Names::__next__, method))
+        return raiseAttrError(iterator, Names::__next__);
+
+    pushStack(method.method,
+              method.isCallable ? iterator : Value(UninitializedSlot),
+              None);
+}
+
+void
+Interpreter::executeInstr_RangeIteratorNext(Traced<Instr*> instr)
+{
+    if (!peekStack().isInt32()) {
+        // Not a builtin range so call the iterator's next method.
+        Stack<Value> target(peekStack(2));
+        Stack<Value> result;
+        bool ok = call(target, peekStack(1), result);
+        pushStack(result);
+        bool finished = !ok && result.isObject() && result.is<StopIteration>();
+        if (!finished && !ok)
+            return raiseException();
+
+        pushStack(Boolean::get(!finished));
+        return;
+    }
+
+    int32_t current = peekStack(2).asInt32();
+    int32_t stop = peekStack(1).asInt32();
+    int32_t step = peekStack(0).asInt32();
+    int32_t value;
+    if (!Range::next(current, stop, step, value)) {
+        pushStack(None, Boolean::get(false));
+        return;
+    }
+
+    stack[stack.size() - 3] = Value(current);
+    pushStack(Value(value), Boolean::get(true));
 }
 
 bool Interpreter::maybeCallBinaryOp(Name name,
@@ -1222,6 +1726,26 @@ Interpreter::executeInstr_AugAssignUpdate(Traced<BinaryOpInstr*> instr)
     Stack<Value> right(peekStack(0));
     Stack<Value> left(peekStack(1));
 
+    if (op == BinaryAdd && left.is<String>() && right.is<String>()) {
+        // Append strings directly so that repeated appends can extend the
+        // result in place.
+        {
+            Stack<String*> a(left.as<String>());
+            Stack<String*> b(right.as<String>());
+            Stack<Value> result(String::append(a, b));
+            popStack(2);
+            pushStack(result);
+        }
+
+        if (instr->canAddStub()) {
+            Stack<StubInstr*> stub(
+                gc.create<BinaryOpStubInstr>(Instr_AugAssignUpdate_String,
+                                             currentInstr()));
+            insertStubInstr(instr, stub);
+        }
+        return;
+    }
+
     // Find the method to call and execute it.
     StackMethodAttr method;
     bool reversed;
@@ -1295,18 +1819,6 @@ Interpreter::executeInstr_SuspendGenerator(Traced<Instr*> instr)
     gen->suspend(*this, value);
 }
 
-void
-Interpreter::executeInstr_EnterCatchRegion(Traced<BranchInstr*> instr)
-{
-    pushExceptionHandler(ExceptionHandler::CatchHandler, instr->offset());
-}
-
-void
-Interpreter::executeInstr_LeaveCatchRegion(Traced<Instr*> instr)
-{
-    popExceptionHandler(ExceptionHandler::CatchHandler);
-}
-
 void
 Interpreter::executeInstr_MatchCurrentException(Traced<Instr*> instr)
 {
@@ -1324,18 +1836,6 @@ Interpreter::executeInstr_HandleCurrentException(Traced<Instr*> instr)
     finishHandlingException();
 }
 
-void
-Interpreter::executeInstr_EnterFinallyRegion(Traced<BranchInstr*> instr)
-{
-    pushExceptionHandler(ExceptionHandler::FinallyHandler, instr->offset());
-}
-
-void
-Interpreter::executeInstr_LeaveFinallyRegion(Traced<Instr*> instr)
-{
-    popExceptionHandler(ExceptionHandler::FinallyHandler);
-}
-
 void
 Interpreter::executeInstr_FinishExceptionHandler(Traced<Instr*> instr)
 {
@@ -1358,6 +1858,27 @@ Interpreter::executeInstr_ListAppend(Traced<Instr*> instr)
     pushStack(None);
 }
 
+void
+Interpreter::executeInstr_CallInit(Traced<CountInstr*> instr)
+{
+    Stack<Value> initFunc(peekStack(instr->count));
+    startCall(initFunc, instr->count, Layout::Empty, 1);
+}
+
+void
+Interpreter::executeInstr_FinishInit(Traced<Instr*> instr)
+{
+    // Leave the new instance on the stack to be returned.
+    Value result = popStack();
+    if (result.toObject() != None) {
+        raise<TypeError>("__init__() should return None");
+        return;
+    }
+
+    Stack<Object*> instance(peekStack(0).toObject());
+    instance->type()->trackInstanceLayout(instance);
+}
+
 void
 Interpreter::executeInstr_AssertStackDepth(Traced<CountInstr*> instr)
 {
@@ -1554,6 +2075,19 @@ bool Interpreter::run(MutableTraced<Value> resultOut)
         }
     end_handle_instr();
 
+    start_handle_instr(AugAssignUpdate_String, BinaryOpStubInstr);
+        if (!peekStack(0).is<String>() || !peekStack(1).is<String>())
+            dispatchNextStub();
+
+        {
+            Stack<String*> b(peekStack(0).as<String>());
+            Stack<String*> a(peekStack(1).as<String>());
+            Value result = String::append(a, b);
+            popStack(2);
+            pushStack(result);
+        }
+    end_handle_instr();
+
 #define define_compare_op_int_stub(name, x, y, z)                             \
     start_handle_instr(CompareOpInt_##name, CompareOpStubInstr);              \
         if (!peekStack(0).isInt32() || !peekStack(1).isInt32())               \
@@ -1580,6 +2114,134 @@ bool Interpreter::run(MutableTraced<Value> resultOut)
     for_each_compare_op(define_compare_op_float_stub);
 #undef define_compare_op_float_stub
 
+#define define_iterator_next_stub(name, cls)                                  \
+    start_handle_instr(IteratorNext_##name, IteratorNextStubInstr);           \
+        Value iterator = peekStack();                                         \
+        if (!iterator.is<cls>())                                              \
+            dispatchNextStub();                                               \
+                                                                              \
+        pushStack(None);                                                      \
+        bool ok = iterator.as<cls>()->next(refStack());                       \
+        Value result = peekStack();                                           \
+        if (!ok && !(result.isObject() && result.is<StopIteration>()))        \
+            raiseException();                                                 \
+        else                                                                  \
+            pushStack(Boolean::get(ok));                                      \
+    end_handle_instr()
+
+    define_iterator_next_stub(List, ListIter);
+    define_iterator_next_stub(Tuple, TupleIter);
+    define_iterator_next_stub(Range, RangeIter);
+    define_iterator_next_stub(Dict, DictIter);
+    define_iterator_next_stub(Set, SetIter);
+#undef define_iterator_next_stub
+
+    start_handle_instr(IteratorNext_Generator, IteratorNextStubInstr);
+        Value iterator = peekStack();
+        if (!iterator.is<GeneratorIter>())
+            dispatchNextStub();
+
+        // Switch straight to the generator's frame rather than calling its
+        // __next__ method.  It leaves the next value and a boolean on our
+        // stack when it suspends or finishes.
+        {
+            Stack<GeneratorIter*> gen(iterator.as<GeneratorIter>());
+            gen->resume(*this, true);
+        }
+    end_handle_instr();
+
+#define define_get_item_stub(name, cls)                                       \
+    start_handle_instr(GetItem_##name, SubscriptStubInstr);                   \
+        Value container = peekStack(1);                                       \
+        Value index = peekStack(0);                                           \
+        if (container.type() != cls::ObjectClass || !index.isInt32())         \
+            dispatchNextStub();                                               \
+                                                                              \
+        cls* seq = container.as<cls>();                                       \
+        int32_t i = WrapIndex(index.asInt32(), seq->len());                   \
+        if (i < 0 || i >= seq->len())                                         \
+            dispatchNextStub();                                               \
+                                                                              \
+        popStack(2);                                                          \
+        pushStack(seq->getitem(i));                                           \
+    end_handle_instr()
+
+    define_get_item_stub(List, List);
+    define_get_item_stub(Tuple, Tuple);
+#undef define_get_item_stub
+
+    start_handle_instr(GetItem_String, SubscriptStubInstr);
+        Value container = peekStack(1);
+        Value index = peekStack(0);
+        if (container.type() != String::ObjectClass || !index.isInt32())
+            dispatchNextStub();
+
+        String* str = container.as<String>();
+        int32_t i = WrapIndex(index.asInt32(), str->size());
+        if (i < 0 || size_t(i) >= str->size())
+            dispatchNextStub();
+
+        Value result = String::get(&str->data()[i], 1);
+        popStack(2);
+        pushStack(result);
+    end_handle_instr();
+
+    start_handle_instr(GetItem_Dict, SubscriptStubInstr);
+        Value container = peekStack(1);
+        if (container.type() != Dict::ObjectClass ||
+            !IsSimpleDictKey(peekStack(0)))
+        {
+            dispatchNextStub();
+        }
+
+        // Missing keys are handled by the generic path, which raises KeyError.
+        bool found;
+        {
+            Stack<Dict*> dict(container.as<Dict>());
+            Stack<Value> key(peekStack(0));
+            Stack<Value> result;
+            found = dict->getitem(key, result);
+            if (found) {
+                popStack(2);
+                pushStack(result);
+            }
+        }
+        if (!found)
+            dispatchNextStub();
+    end_handle_instr();
+
+    start_handle_instr(SetItem_List, SubscriptStubInstr);
+        Value container = peekStack(1);
+        Value index = peekStack(0);
+        if (container.type() != List::ObjectClass || !index.isInt32())
+            dispatchNextStub();
+
+        List* list = container.as<List>();
+        int32_t i = WrapIndex(index.asInt32(), list->len());
+        if (i < 0 || i >= list->len())
+            dispatchNextStub();
+
+        list->setitem(i, peekStack(2));
+        popStack(2);
+    end_handle_instr();
+
+    start_handle_instr(SetItem_Dict, SubscriptStubInstr);
+        Value container = peekStack(1);
+        if (container.type() != Dict::ObjectClass ||
+            !IsSimpleDictKey(peekStack(0)))
+        {
+            dispatchNextStub();
+        }
+
+        {
+            Stack<Dict*> dict(container.as<Dict>());
+            Stack<Value> key(peekStack(0));
+            Stack<Value> value(peekStack(2));
+            dict->setitem(key, value);
+        }
+        popStack(2);
+    end_handle_instr();
+
 #undef fetchInstr
 #undef execInstr
 #undef dispatch
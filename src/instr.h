@@ -48,6 +48,7 @@ struct Interpreter;
     type(IdentInstr)                                                         \
     type(StackSlotInstr)                                                     \
     type(LexicalFrameInstr)                                                  \
+    type(LexicalSlotInstr)                                                   \
     type(GlobalNameInstr)                                                    \
     type(GlobalSlotInstr)                                                    \
     type(BuiltinsSlotInstr)                                                  \
@@ -63,6 +64,8 @@ struct Interpreter;
     type(BuiltinBinaryOpInstr)                                               \
     type(CompareOpInstr)                                                     \
     type(CompareOpStubInstr)                                                 \
+    type(IteratorNextStubInstr)                                              \
+    type(SubscriptStubInstr)                                                 \
     type(LoopControlJumpInstr)
 
 #define for_each_inline_instr(instr)                                         \
@@ -77,6 +80,9 @@ struct Interpreter;
     instr(GetLexical, LexicalFrameInstr)                                     \
     instr(SetLexical, LexicalFrameInstr)                                     \
     instr(DelLexical, LexicalFrameInstr)                                     \
+    instr(GetLexicalSlot, LexicalSlotInstr)                                  \
+    instr(SetLexicalSlot, LexicalSlotInstr)                                  \
+    instr(DelLexicalSlot, LexicalSlotInstr)                                  \
     instr(GetGlobal, GlobalNameInstr)                                        \
     instr(SetGlobal, GlobalNameInstr)                                        \
     instr(DelGlobal, GlobalNameInstr)                                        \
@@ -88,6 +94,7 @@ struct Interpreter;
     instr(CallMethod, CountInstr)                                            \
     instr(CallWithFullArgs, CallWithFullArgsInstr)                           \
     instr(CallMethodWithFullArgs, CallWithFullArgsInstr)                     \
+    instr(CallUnpacked, CountInstr)                                          \
     instr(CreateEnv, Instr)                                                  \
     instr(SetEnv, ValueInstr)                                                \
     instr(InitStackLocals, CountInstr)                                       \
@@ -108,6 +115,8 @@ struct Interpreter;
     instr(Dict, CountInstr)                                                  \
     instr(Set, CountInstr)                                                   \
     instr(Slice, Instr)                                                      \
+    instr(GetItem, Instr)                                                    \
+    instr(SetItem, Instr)                                                    \
     instr(AssertionFailed, Instr)                                            \
     instr(MakeClassFromFrame, IdentInstr)                                    \
     instr(Destructure, CountInstr)                                           \
@@ -115,6 +124,8 @@ struct Interpreter;
     instr(Raise, Instr)                                                      \
     instr(GetIterator, Instr)                                                \
     instr(IteratorNext, Instr)                                               \
+    instr(GetRangeIterator, CountInstr)                                      \
+    instr(RangeIteratorNext, Instr)                                          \
     instr(BinaryOp, BinaryOpInstr)                                           \
     instr(CompareOp, CompareOpInstr)                                         \
     instr(AugAssignUpdate, BinaryOpInstr)                                    \
@@ -122,15 +133,13 @@ struct Interpreter;
     instr(ResumeGenerator, Instr)                                            \
     instr(LeaveGenerator, Instr)                                             \
     instr(SuspendGenerator, Instr)                                           \
-    instr(EnterCatchRegion, BranchInstr)                                     \
-    instr(LeaveCatchRegion, Instr)                                           \
     instr(MatchCurrentException, Instr)                                      \
     instr(HandleCurrentException, Instr)                                     \
-    instr(EnterFinallyRegion, BranchInstr)                                   \
-    instr(LeaveFinallyRegion, Instr)                                         \
     instr(FinishExceptionHandler, Instr)                                     \
     instr(LoopControlJump, LoopControlJumpInstr)                             \
     instr(ListAppend, Instr)                                                 \
+    instr(CallInit, CountInstr)                                              \
+    instr(FinishInit, Instr)                                                 \
     instr(AssertStackDepth, CountInstr)
 
 #define for_each_stub_instr(instr)                                           \
@@ -156,6 +165,7 @@ struct Interpreter;
     instr(BinaryOpFloat_TrueDiv, BinaryOpStubInstr)                          \
     instr(BinaryOpBuiltin, BuiltinBinaryOpInstr)                             \
     instr(BinaryOpBuiltinReversed, BuiltinBinaryOpInstr)                     \
+    instr(AugAssignUpdate_String, BinaryOpStubInstr)                         \
     instr(CompareOpInt_LT, CompareOpStubInstr)                               \
     instr(CompareOpInt_LE, CompareOpStubInstr)                               \
     instr(CompareOpInt_GT, CompareOpStubInstr)                               \
@@ -167,7 +177,19 @@ struct Interpreter;
     instr(CompareOpFloat_GT, CompareOpStubInstr)                             \
     instr(CompareOpFloat_GE, CompareOpStubInstr)                             \
     instr(CompareOpFloat_EQ, CompareOpStubInstr)                             \
-    instr(CompareOpFloat_NE, CompareOpStubInstr)
+    instr(CompareOpFloat_NE, CompareOpStubInstr)                             \
+    instr(IteratorNext_List, IteratorNextStubInstr)                          \
+    instr(IteratorNext_Tuple, IteratorNextStubInstr)                         \
+    instr(IteratorNext_Range, IteratorNextStubInstr)                         \
+    instr(IteratorNext_Dict, IteratorNextStubInstr)                          \
+    instr(IteratorNext_Set, IteratorNextStubInstr)                           \
+    instr(IteratorNext_Generator, IteratorNextStubInstr)                     \
+    instr(GetItem_List, SubscriptStubInstr)                                  \
+    instr(GetItem_Tuple, SubscriptStubInstr)                                 \
+    instr(GetItem_String, SubscriptStubInstr)                                \
+    instr(GetItem_Dict, SubscriptStubInstr)                                  \
+    instr(SetItem_List, SubscriptStubInstr)                                  \
+    instr(SetItem_Dict, SubscriptStubInstr)
 
 #define for_each_instr(instr)                                                \
     for_each_inline_instr(instr)                                             \
@@ -178,6 +200,7 @@ struct Interpreter;
     _(Const, 1)                                                              \
     _(GetStackLocal, 1)                                                      \
     _(GetLexical, 1)                                                         \
+    _(GetLexicalSlot, 1)                                                     \
     _(GetGlobal, 1)                                                          \
     _(SetAttr, -1)                                                           \
     _(DelAttr, -1)                                                           \
@@ -199,10 +222,14 @@ struct Interpreter;
     _(Dict, 1)                                                               \
     _(Set, 1)                                                                \
     _(Slice, -2)                                                             \
+    _(GetItem, -1)                                                           \
+    _(SetItem, -2)                                                           \
     _(AssertionFailed, -1) /* to balance stack depth calculations */         \
     _(MakeClassFromFrame, 1)                                                 \
     _(Destructure, -1)                                                       \
     _(IteratorNext, 2)                                                       \
+    _(GetRangeIterator, 2)                                                   \
+    _(RangeIteratorNext, 2)                                                  \
     _(BinaryOp, -1)                                                          \
     _(CompareOp, -1)                                                         \
     _(AugAssignUpdate, -1)                                                   \
@@ -217,12 +244,14 @@ struct Interpreter;
     _(CallMethod, CountInstr, count, -1)                                     \
     _(CallWithFullArgs, CallWithFullArgsInstr, slotCount(), -1)              \
     _(CallMethodWithFullArgs, CallWithFullArgsInstr, slotCount(), -1)        \
+    _(CallUnpacked, CountInstr, count, -1)                                   \
     _(InitStackLocals, CountInstr, count, 1)                                 \
     _(Lambda, LambdaInstr, defaultCount(), -1)                               \
     _(Tuple, CountInstr, count, -1)                                          \
     _(List, CountInstr, count, -1)                                           \
     _(Dict, CountInstr, count, -2)                                           \
     _(Set, CountInstr, count, -1)                                            \
+    _(GetRangeIterator, CountInstr, count, -1)                               \
     _(Destructure, CountInstr, count, 1)
 
 #define for_each_unconditonal_branch_instr(_)                                \
@@ -383,6 +412,25 @@ struct LexicalFrameInstr : public IdentInstrBase
     const unsigned frameIndex;
 };
 
+// Access a variable captured from a function's locals by its slot in the
+// environment |frameIndex| levels up the environment chain.
+struct LexicalSlotInstr : public IdentInstrBase
+{
+    define_instr_type(LexicalSlotInstr);
+
+    LexicalSlotInstr(InstrCode code, unsigned frameIndex, Name ident,
+                     unsigned slot)
+      : IdentInstrBase(code, ident), frameIndex(frameIndex), slot(slot)
+    {
+        assert(instrType(code) == Type);
+    }
+
+    void print(ostream& s) const override;
+
+    const unsigned frameIndex;
+    const unsigned slot;
+};
+
 struct GlobalNameInstr : public IdentInstrBase
 {
     define_instr_type(GlobalNameInstr);
@@ -547,7 +595,8 @@ struct CallWithFullArgsInstr : public Instr
         argsPos(argsPos),
         maybePosCount(maybePosCount),
         keywords(keywords),
-        mappingArg(mappingArg)
+        mappingArg(mappingArg),
+        cachedArgCount_(0)
     {
         assert(instrType(code) == Type);
     }
@@ -563,6 +612,21 @@ struct CallWithFullArgsInstr : public Instr
 
     size_t slotCount(Frame* frame, size_t stackPos) const;
 
+    // Each call site caches where each formal parameter of the last function
+    // called comes from, so that calls with the same function and keywords
+    // can shuffle their arguments into place without looking up names.  A
+    // source of -1 means the parameter takes its default value.
+    bool hasCachedArgSources(FunctionInfo* info, Layout* keywords,
+                             unsigned argCount) const {
+        return info == cachedInfo_ && keywords == cachedKeywords_ &&
+               argCount == cachedArgCount_;
+    }
+    const vector<int>& cachedArgSources() const { return cachedArgSources_; }
+    void setCachedArgSources(Traced<FunctionInfo*> info,
+                             Traced<Layout*> keywords,
+                             unsigned argCount,
+                             vector<int>&& sources);
+
     void print(ostream& s) const override;
     void traceChildren(Tracer& t) override;
 
@@ -570,6 +634,12 @@ struct CallWithFullArgsInstr : public Instr
     const size_t maybePosCount;
     Heap<Layout*> keywords;
     const bool mappingArg;
+
+  private:
+    Heap<FunctionInfo*> cachedInfo_;
+    Heap<Layout*> cachedKeywords_;
+    unsigned cachedArgCount_;
+    vector<int> cachedArgSources_;
 };
 
 struct BuiltinMethodInstr : public StubInstr
@@ -742,6 +812,28 @@ struct CompareOpStubInstr : public StubInstr
     }
 };
 
+struct IteratorNextStubInstr : public StubInstr
+{
+    define_instr_type(IteratorNextStubInstr);
+
+    IteratorNextStubInstr(InstrCode code, Traced<Instr*> next)
+      : StubInstr(code, next)
+    {
+        assert(instrType(code) == Type);
+    }
+};
+
+struct SubscriptStubInstr : public StubInstr
+{
+    define_instr_type(SubscriptStubInstr);
+
+    SubscriptStubInstr(InstrCode code, Traced<Instr*> next)
+      : StubInstr(code, next)
+    {
+        assert(instrType(code) == Type);
+    }
+};
+
 struct LoopControlJumpInstr : public Instr
 {
     define_instr_type(LoopControlJumpInstr);
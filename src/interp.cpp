@@ -15,6 +15,10 @@
 
 #include "value-inl.h"
 
+#include <map>
+
+#include <sys/resource.h>
+
 #ifdef LOG_EXECUTION
 bool logFrames = false;
 bool logExecution = false;
@@ -25,36 +29,38 @@ bool logInstrCounts = false;
 size_t instrCounts[InstrCodeCount] = {0};
 #endif
 
+// Number of exceptions raised by class name.
+bool logExceptionStats = false;
+static map<string, size_t> exceptionCounts;
+
 GlobalRoot<Block*> Interpreter::AbortTrampoline;
+RootVector<Block*> Interpreter::InitTrampolines;
+RootVector<Block*> Interpreter::SetItemTrampolines;
 
 GlobalRoot<Interpreter*> interp;
 
-ExceptionHandler::ExceptionHandler(Type type, unsigned stackPos, unsigned offset)
-  : next_(nullptr), type_(type), stackPos_(stackPos), offset_(offset)
-{}
-
-void ExceptionHandler::setNext(ExceptionHandler* eh)
-{
-    assert(!next_);
-    next_ = eh;
-}
-
-void ExceptionHandler::traceChildren(Tracer& t)
-{
-    gc.trace(t, &next_);
-}
-
 Interpreter::Interpreter()
   : instrp(nullptr),
     frame(nullptr),
     stack(1),
+    recursionLimit_(DefaultRecursionLimit),
     inExceptionHandler_(false),
     jumpKind_(JumpKind::None),
     currentException_(nullptr),
     deferredReturnValue_(None),
     remainingFinallyCount_(0),
     loopControlTarget_(0)
-{}
+{
+    // Raise RecursionError rather than overflowing the native stack, leaving
+    // some space free for natives and the runtime. This assumes the stack
+    // grows downwards.
+    size_t stackSize = MaxNativeStackSize;
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+        stackSize = min(stackSize, size_t(limit.rlim_cur));
+    char marker;
+    nativeStackLimit_ = uintptr_t(&marker) - (stackSize - stackSize / 8);
+}
 
 Interpreter::~Interpreter()
 {
@@ -62,6 +68,8 @@ Interpreter::~Interpreter()
     if (logInstrCounts)
         printInstrCounts();
 #endif
+    if (logExceptionStats)
+        printExceptionCounts();
 }
 
 void Interpreter::init()
@@ -74,12 +82,37 @@ void Interpreter::init()
     AbortTrampoline->append<Instr_Abort>();
     AbortTrampoline->setMaxStackDepth(1);
 
+    // Create blocks that call __init__ on a new instance and return it. The
+    // stack holds the instance, __init__ and its arguments.
+    for (unsigned i = 0; i <= MaxInitTrampolineArgs; i++) {
+        Stack<Block*> block(gc.create<Block>(parent, global,
+                                             Env::InitialLayout, 0, false));
+        block->append<Instr_CallInit>(i + 1);
+        block->append<Instr_FinishInit>();
+        block->append<Instr_Return>();
+        block->setMaxStackDepth(i + 3);
+        InitTrampolines.push_back(block);
+    }
+
+    // Create blocks that call __setitem__ and return the assigned value. The
+    // stack holds the value, __setitem__ and its arguments.
+    for (unsigned i = 0; i <= 1; i++) {
+        Stack<Block*> block(gc.create<Block>(parent, global,
+                                             Env::InitialLayout, 0, false));
+        block->append<Instr_Call>(i + 2);
+        block->append<Instr_Pop>();
+        block->append<Instr_Return>();
+        block->setMaxStackDepth(i + 4);
+        SetItemTrampolines.push_back(block);
+    }
+
     interp.init(gc.create<Interpreter>());
 }
 
 void Interpreter::traceChildren(Tracer& t)
 {
-    gc.traceVector(t, &frames);
+    for (size_t i = 0; i < frames.size(); i++)
+        GCTraits<Frame>::trace(t, &frames[i]);
     gc.traceVector(t, &stack);
     gc.trace(t, &currentException_);
     gc.trace(t, &deferredReturnValue_);
@@ -94,15 +127,18 @@ bool Interpreter::exec(Traced<Block*> block, MutableTraced<Value> resultOut)
     }
 #endif
 
+    if (exceedsRecursionLimit() || exceedsNativeStackLimit()) {
+        failWithRecursionError(resultOut);
+        return false;
+    }
+
     AutoSetAndRestoreValue<InstrThunk*> saveInstrp(instrp, nullptr);
     pushFrame(block, stack.size(), 0);
 #ifdef DEBUG
     unsigned initialSize = stack.size();
 #endif
-    size_t initialCapacity = stack.capacity();
     bool ok = run(resultOut);
     assert(stack.size() == initialSize);
-    stack.reserve(initialCapacity); // todo: this doesn't shrink
     return ok;
 }
 
@@ -117,8 +153,7 @@ void Interpreter::insertStackEntries(unsigned offsetFromTop, Value value,
     }
 #endif
 
-    assert(count == 1); // todo
-    stack.insert(stack.end() - offsetFromTop, value);
+    stack.insert(stack.end() - offsetFromTop, value, count);
 }
 
 void Interpreter::eraseStackEntries(unsigned offsetFromTop, size_t count)
@@ -253,8 +288,6 @@ void Interpreter::popFrame()
     assert(!frames.empty());
     assert(frame = &frames.back());
 
-    assert(!frame->exceptionHandlers());
-
 #ifdef LOG_EXECUTION
     if (logFrames) {
         TokenPos pos = frame->block()->getPos(instrp - 1);
@@ -269,7 +302,8 @@ void Interpreter::popFrame()
     stack.resize(pos); // todo: log removed values
 
     instrp = frame->returnPoint();
-    frames.pop_back();
+    if (frames.pop_back())
+        shrinkStack();
     frame = frames.empty() ? nullptr : &frames.back();
 
 #ifdef LOG_EXECUTION
@@ -281,6 +315,24 @@ void Interpreter::popFrame()
 #endif
 }
 
+void Interpreter::shrinkStack()
+{
+    // Release value stack storage left over from deep recursion, keeping
+    // enough space for the maximum depth of every remaining frame.
+    if (stack.capacity() < MinShrinkStackCapacity)
+        return;
+
+    size_t required = stack.size();
+    for (size_t i = 0; i < frames.size(); i++) {
+        const Frame& f = frames[i];
+        size_t depth = f.stackPos() + f.block()->maxStackDepth();
+        required = max(required, depth);
+    }
+
+    if (stack.capacity() > required * 2)
+        stack.shrink_to_fit(required);
+}
+
 void Interpreter::setFrameEnv(Env* env)
 {
     AutoAssertNoGC nogc;
@@ -334,35 +386,34 @@ GeneratorIter* Interpreter::getGeneratorIter()
 void Interpreter::resumeGenerator(Traced<Block*> block,
                                   Traced<Env*> env,
                                   unsigned ipOffset,
-                                  TracedVector<Value> savedStack,
-                                  Traced<ExceptionHandler*> savedHandlers)
+                                  TracedVector<Value> savedStack)
 {
     pushFrame(block, stack.size(), 0);
     setFrameEnv(env);
-    getFrame()->setHandlers(savedHandlers);
     instrp += ipOffset;
-    // todo: can copy this in one go
-    for (auto i = savedStack.begin(); i != savedStack.end(); i++)
-        pushStack(*i);
+    size_t pos = stack.size();
+    stack.resize(pos + savedStack.size());
+    for (size_t i = 0; i < savedStack.size(); i++) {
+        logStackPush(savedStack[i]);
+        stack[pos + i] = savedStack[i];
+    }
 }
 
 // todo: this should take a MutableTracedVector, but it's not worth defining it
 // for this single use.
 unsigned
-Interpreter::suspendGenerator(HeapVector<Value>& savedStack,
-                              MutableTraced<ExceptionHandler*> savedHandlers)
+Interpreter::suspendGenerator(HeapVector<Value>& savedStack)
 {
     Frame* frame = getFrame();
     assert(frame->stackPos() <= stack.size());
     unsigned len = stack.size() - frame->stackPos();
     assert(savedStack.empty());
     savedStack.resize(len);
-    // todo: probably a better way to do this with STL
-    for (unsigned i = len; i != 0; i--)
-        savedStack[i - 1] = popStack();
+    for (unsigned i = 0; i < len; i++)
+        savedStack[i] = stack[frame->stackPos() + i];
+    logStackPop(len);
+    stack.resize(frame->stackPos());
     unsigned ipOffset = instrp - frame->block()->startInstr();
-    assert(!savedHandlers);
-    savedHandlers = frame->takeHandlers();
     popFrame();
     return ipOffset;
 }
@@ -374,23 +425,6 @@ unsigned Interpreter::currentOffset()
     return instrp - start - 1;
 }
 
-void Interpreter::pushExceptionHandler(ExceptionHandler::Type type,
-                                       unsigned offset)
-{
-    assert(offset);
-    // todo: Why do we store instruction offsets rather than indices?
-    Stack<ExceptionHandler*> handler(
-        gc.create<ExceptionHandler>(type, stack.size(), offset + currentOffset()));
-    getFrame()->pushHandler(handler);
-}
-
-void Interpreter::popExceptionHandler(ExceptionHandler::Type type)
-{
-    ExceptionHandler* eh = getFrame()->popHandler();
-    assert(eh->type() == type);
-    (void)eh;
-}
-
 void Interpreter::raiseException(Traced<Value> exception)
 {
     pushStack(exception);
@@ -416,8 +450,8 @@ bool Interpreter::handleException()
 
     assert(value.isInstanceOf(Exception::ObjectClass));
     Stack<Exception*> exception(value.as<Exception>());
-    if (!exception->hasTraceback())
-        exception->recordTraceback(instrp ? instrp - 1 : nullptr);
+    if (logExceptionStats)
+        exceptionCounts[exception->className()]++;
     if (startExceptionHandler(exception))
         return true;
 
@@ -429,16 +463,23 @@ bool Interpreter::handleException()
 
 bool Interpreter::startExceptionHandler(Traced<Exception*> exception)
 {
-    while (!getFrame()->exceptionHandlers()) {
+    const ExceptionHandler* handler;
+    for (;;) {
+        Block* block = getFrame()->block();
+        exception->recordTraceback(block, instrp - 1, frameCount());
+        handler = block->findExceptionHandler(currentOffset());
+        if (handler)
+            break;
         popFrame();
         if (!instrp)
             return false;
     }
 
-    ExceptionHandler* handler = getFrame()->popHandler();
-    instrp = getFrame()->block()->startInstr() + handler->offset();
-    assert(handler->stackPos() <= stack.size());
-    stack.resize(handler->stackPos());
+    Frame* frame = getFrame();
+    instrp = frame->block()->startInstr() + handler->target;
+    unsigned stackPos = frame->stackPos() + handler->stackDepth;
+    assert(stackPos <= stack.size());
+    stack.resize(stackPos);
     inExceptionHandler_ = true;
     jumpKind_ = JumpKind::Exception;
     currentException_ = exception;
@@ -450,18 +491,18 @@ bool Interpreter::startNextFinallySuite(JumpKind jumpKind)
     assert(jumpKind == JumpKind::Return || jumpKind == JumpKind::LoopControl);
 
     Frame* frame = getFrame();
-    while (frame->exceptionHandlers())
-    {
-        ExceptionHandler* handler = frame->popHandler();
-        if (handler->type() == ExceptionHandler::FinallyHandler) {
-            inExceptionHandler_ = true;
-            jumpKind_ = jumpKind;
-            instrp = getFrame()->block()->startInstr() + handler->offset();
-            return true;
-        }
-    }
+    const ExceptionHandler* handler =
+        frame->block()->findExceptionHandler(currentOffset(), true);
+    if (!handler)
+        return false;
 
-    return false;
+    inExceptionHandler_ = true;
+    jumpKind_ = jumpKind;
+    instrp = frame->block()->startInstr() + handler->target;
+    unsigned stackPos = frame->stackPos() + handler->stackDepth;
+    assert(stackPos <= stack.size());
+    stack.resize(stackPos);
+    return true;
 }
 
 bool Interpreter::isHandlingException() const
@@ -525,7 +566,7 @@ void Interpreter::finishHandlingException()
     inExceptionHandler_ = false;
     jumpKind_ = JumpKind::None;
     currentException_ = nullptr;
-    deferredReturnValue_ = None;
+    deferredReturnValue_ = Value(None);
     remainingFinallyCount_ = 0;
     loopControlTarget_ = 0;
 }
@@ -572,7 +613,10 @@ void Interpreter::raiseNameError(Name ident)
 bool Interpreter::syncCall(Traced<Value> targetValue, NativeArgs args,
                            MutableTraced<Value> resultOut)
 {
+    // The arguments are pushed above the current frame's stack so space is
+    // not already reserved for them.
     unsigned argCount = args.size();
+    ensureStackSpace(stack.size() + argCount);
     for (unsigned i = 0; i < argCount; i++)
         pushStack(args[i]);
     return syncCall(targetValue, argCount, resultOut);
@@ -586,6 +630,15 @@ bool Interpreter::syncCall(Traced<Value> targetValue, unsigned argCount,
     // interpreter loop knows to exit rather than resume the the previous frame.
     AutoSetAndRestoreValue<InstrThunk*> saveInstrp(instrp, nullptr);
 
+    if (exceedsNativeStackLimit()) {
+        popStack(argCount);
+        failWithRecursionError(resultOut);
+        return false;
+    }
+
+#ifdef DEBUG
+    unsigned initialSize = stack.size() - argCount;
+#endif
     CallStatus status = setupCall(targetValue, argCount, Layout::Empty, 0,
                                   resultOut);
     if (status != CallStarted) {
@@ -593,11 +646,8 @@ bool Interpreter::syncCall(Traced<Value> targetValue, unsigned argCount,
         return status == CallFinished;
     }
 
-#ifdef DEBUG
-    unsigned initialSize = stack.size() - getFrame()->block()->argCount();
-#endif
     bool ok = run(resultOut);
-    assert(stack.size() == initialSize - 1);
+    assert(stack.size() == initialSize);
     return ok;
 }
 
@@ -643,6 +693,13 @@ Interpreter::failWithTypeError(string message, MutableTraced<Value> resultOut)
     return CallError;
 }
 
+Interpreter::CallStatus
+Interpreter::failWithRecursionError(MutableTraced<Value> resultOut)
+{
+    Raise<RecursionError>("maximum recursion depth exceeded", resultOut);
+    return CallError;
+}
+
 inline bool Interpreter::checkArguments(Traced<Callable*> callable,
                                         const TracedVector<Value>& args,
                                         MutableTraced<Value> resultOut)
@@ -856,6 +913,8 @@ Interpreter::CallStatus Interpreter::setupCall(Traced<Value> targetValue,
         Stack<Function*> function(target->as<Function>());
         if (!checkArguments(function, stackSlice(argCount), resultOut))
             return CallError;
+        if (exceedsRecursionLimit())
+            return failWithRecursionError(resultOut);
         Stack<Block*> block(function->block());
         if (keywordArgs == Layout::Empty) {
             mungeSimpleArguments(function, argCount);
@@ -874,12 +933,36 @@ Interpreter::CallStatus Interpreter::setupCall(Traced<Value> targetValue,
         if (cls->maybeGetClassAttr(Names::__new__, func) && !func.isNone()) {
             insertStackEntries(argCount, Value(cls));
             TracedVector<Value> funcArgs(stackSlice(argCount + 1));
-            if (!syncCall(func, funcArgs, resultOut)) {
+            if (func.is<Native>() && func.as<Native>()->func() == object_new) {
+                resultOut = cls->createInstance();
+            } else if (func.is<Native>()) {
+                // Call native __new__ on the arguments in place.
+                if (setupCall(func, argCount + 1, Layout::Empty, 0,
+                              resultOut) == CallError)
+                {
+                    return CallError;
+                }
+            } else if (!syncCall(func, funcArgs, resultOut)) {
                 return CallError;
             }
             if (resultOut.isInstanceOf(cls)) {
                 Stack<Value> initFunc;
-                if (target->maybeGetAttr(Names::__init__, initFunc)) {
+                if (cls->maybeGetClassAttr(Names::__init__, initFunc)) {
+                    if (initFunc.is<Function>() &&
+                        keywordArgs == Layout::Empty &&
+                        argCount <= MaxInitTrampolineArgs)
+                    {
+                        // Call __init__ from a trampoline frame so that it
+                        // runs in the current interpreter loop rather than a
+                        // nested one.
+                        funcArgs[0] = resultOut;
+                        insertStackEntries(argCount + 1, resultOut, 2);
+                        stack[stack.size() - argCount - 2] = initFunc;
+                        Stack<Block*> block(InitTrampolines[argCount]);
+                        pushFrame(block, stack.size() - argCount - 3,
+                                  extraPopCount);
+                        return CallStarted;
+                    }
                     Stack<Value> initResult;
                     funcArgs[0] = resultOut;
                     if (!syncCall(initFunc, funcArgs, initResult)) {
@@ -890,6 +973,8 @@ Interpreter::CallStatus Interpreter::setupCall(Traced<Value> targetValue,
                         return failWithTypeError(
                             "__init__() should return None", resultOut);
                     }
+                    Stack<Object*> instance(resultOut.toObject());
+                    cls->trackInstanceLayout(instance);
                 }
             }
         } else {
@@ -942,6 +1027,14 @@ void Interpreter::replaceAllStubs(Instr* current, Instr* stub)
     it.data = stub;
 }
 
+void Interpreter::printExceptionCounts()
+{
+    cout << dec;
+    printf("Exception count stats\n");
+    for (const auto& i : exceptionCounts)
+        printf("  %25s: %ld\n", i.first.c_str(), i.second);
+}
+
 #ifdef DEBUG
 void Interpreter::printInstrCounts()
 {
@@ -8,6 +8,7 @@
 #include "instr.h"
 #include "token.h"
 #include "value-inl.h"
+#include "vector.h"
 
 #include <vector>
 
@@ -27,36 +28,14 @@ extern bool logInstrCounts;
 extern size_t instrCounts[InstrCodeCount];
 #endif
 
+extern bool logExceptionStats;
+
 struct Callable;
+struct Dict;
 struct Exception;
-struct ExceptionHandler;
 struct Function;
 struct GeneratorIter;
 
-struct ExceptionHandler : public Cell
-{
-    enum Type {
-        CatchHandler, FinallyHandler
-    };
-
-    ExceptionHandler(Type type, unsigned stackPos, unsigned offset);
-
-    ExceptionHandler* next() { return next_; }
-    Type type() { return type_; }
-    unsigned stackPos() { return stackPos_; }
-    unsigned offset() { return offset_; }
-
-    void setNext(ExceptionHandler* eh);
-
-    void traceChildren(Tracer& t) override;
-
-  protected:
-    Heap<ExceptionHandler*> next_;
-    const Type type_;
-    unsigned stackPos_;
-    unsigned offset_;
-};
-
 struct Interpreter : public SweptCell
 {
     Interpreter();
@@ -221,14 +200,38 @@ struct Interpreter : public SweptCell
         return syncCall(callable, 3, resultOut);
     }
 
+    bool callWithArgs(Traced<Value> callable, NativeArgs args,
+                      MutableTraced<Value> resultOut)
+    {
+        for (size_t i = 0; i < args.size(); i++) {
+            Value value(args[i]);
+            logStackPush(value);
+            stack.push_back(value);
+        }
+        return syncCall(callable, args.size(), resultOut);
+    }
+
     void startCall(Traced<Value> callable, unsigned posArgCount,
                    Traced<Layout*> keywordArgs = Layout::Empty,
                    unsigned extraPopCount = 0);
 
+    bool maybeForwardUnpackedArgs(Traced<Value> target, Traced<Value> seq,
+                                  Traced<Dict*> mapping, unsigned stackCount);
+    void startCallWithKeywords(Traced<CallWithFullArgsInstr*> instr,
+                               Traced<Value> callable, unsigned argCount,
+                               Traced<Layout*> keywordArgs,
+                               unsigned extraPopCount);
+
     void popFrame();
 
     size_t frameCount() const { return frames.size(); }
 
+    static const size_t DefaultRecursionLimit = 3000;
+
+    // The maximum number of frames, after which calls raise RecursionError.
+    size_t recursionLimit() const { return recursionLimit_; }
+    void setRecursionLimit(size_t limit) { recursionLimit_ = limit; }
+
     Frame* getFrame() {
         assert(!frames.empty());
         assert(frame == &frames.back());
@@ -263,10 +266,8 @@ struct Interpreter : public SweptCell
     void resumeGenerator(Traced<Block*> block,
                          Traced<Env*> env,
                          unsigned ipOffset,
-                         TracedVector<Value> savedStack,
-                         Traced<ExceptionHandler*> savedHandlers);
-    unsigned suspendGenerator(HeapVector<Value>& savedStack,
-                              MutableTraced<ExceptionHandler*> savedHandlers);
+                         TracedVector<Value> savedStack);
+    unsigned suspendGenerator(HeapVector<Value>& savedStack);
 
     void loopControlJump(unsigned finallyCount, unsigned target);
 
@@ -279,8 +280,6 @@ struct Interpreter : public SweptCell
 
     void raiseException(Traced<Value> exception);
     void raiseException();
-    void pushExceptionHandler(ExceptionHandler::Type type, unsigned offset);
-    void popExceptionHandler(ExceptionHandler::Type type);
     bool isHandlingException() const;
     bool isHandlingDeferredReturn() const;
     bool isHandlingLoopControl() const;
@@ -291,11 +290,31 @@ struct Interpreter : public SweptCell
   private:
     static GlobalRoot<Block*> AbortTrampoline;
 
+    // Blocks used to run __init__ when constructing an instance, indexed by
+    // argument count.
+    static const unsigned MaxInitTrampolineArgs = 8;
+    static RootVector<Block*> InitTrampolines;
+
+    // Blocks used to call a generic __setitem__ method and discard its
+    // result, indexed by whether the method takes the container argument.
+    static RootVector<Block*> SetItemTrampolines;
+
+    // Frames are stored in segments so that they are never moved and deep
+    // recursion doesn't copy the whole frame stack.
+    static const size_t FrameSegmentSize = 256;
+
+    // Don't bother releasing value stack storage below this size.
+    static const size_t MinShrinkStackCapacity = 1024;
+
+    // Limit on native stack size used for nested calls into the interpreter.
+    static const size_t MaxNativeStackSize = 64 * 1024 * 1024;
+
     InstrThunk *instrp;
     Frame* frame;
-    HeapVector<Frame, std::vector<Frame>> frames;
-    // todo: why is std::vector significantly faster?
+    SegmentedStack<Frame, FrameSegmentSize> frames;
     HeapVector<Value> stack;
+    size_t recursionLimit_;
+    uintptr_t nativeStackLimit_;
 
     bool inExceptionHandler_;
     JumpKind jumpKind_;
@@ -308,6 +327,14 @@ struct Interpreter : public SweptCell
 
     void pushFrame(Traced<Block*> block, unsigned stackStartPos,
                    unsigned extraPopCount);
+    bool exceedsRecursionLimit() const {
+        return frames.size() >= recursionLimit_;
+    }
+    bool exceedsNativeStackLimit() const {
+        char marker;
+        return uintptr_t(&marker) < nativeStackLimit_;
+    }
+    void shrinkStack();
     unsigned currentOffset();
     TokenPos currentPos();
 
@@ -327,6 +354,7 @@ struct Interpreter : public SweptCell
                                MutableTraced<Value> resultOut);
     CallStatus failWithTypeError(string message,
                                  MutableTraced<Value> resultOut);
+    CallStatus failWithRecursionError(MutableTraced<Value> resultOut);
     bool checkArguments(Traced<Callable*> callable,
                         const TracedVector<Value>& args,
                         MutableTraced<Value> resultOut);
@@ -386,13 +414,15 @@ struct Interpreter : public SweptCell
     template <typename T>
     void executeUnpackBuiltin(T* seq);
 
-    void executeUnpackGeneric();
+    bool executeUnpackGeneric();
+    bool unpackArgs();
 
     Layout* unpackKeywordMapping(Traced<Layout*> initialKeywords);
 
 #ifdef DEBUG
     void printInstrCounts();
 #endif
+    void printExceptionCounts();
 };
 
 extern GlobalRoot<Interpreter*> interp;
@@ -0,0 +1,365 @@
+#include "iterator.h"
+
+#include "builtin.h"
+#include "exception.h"
+#include "interp.h"
+#include "list.h"
+#include "numeric.h"
+#include "range.h"
+#include "singletons.h"
+
+#include "value-inl.h"
+
+GlobalRoot<Class*> Zip::ObjectClass;
+GlobalRoot<Class*> Map::ObjectClass;
+GlobalRoot<Class*> Enumerate::ObjectClass;
+GlobalRoot<Class*> Filter::ObjectClass;
+
+bool GetIterator(Traced<Value> iterable, MutableTraced<Value> resultOut)
+{
+    if (iterable.is<List>()) {
+        Stack<List*> list(iterable.as<List>());
+        resultOut = gc.create<ListIter>(list);
+        return true;
+    }
+
+    if (iterable.is<Tuple>()) {
+        Stack<Tuple*> tuple(iterable.as<Tuple>());
+        resultOut = gc.create<TupleIter>(tuple);
+        return true;
+    }
+
+    if (iterable.is<Range>()) {
+        Stack<Range*> range(iterable.as<Range>());
+        resultOut = gc.create<RangeIter>(range);
+        return true;
+    }
+
+    // Call __iter__ method to get iterator if it's present, otherwise create a
+    // SequenceIterator wrapping the target iterable.
+    StackMethodAttr method;
+    if (getSpecialMethodAttr(iterable, Names::__iter__, method)) {
+        if (method.isCallable)
+            return interp->call(method.method, iterable, resultOut);
+        return interp->call(method.method, resultOut);
+    }
+
+    if (!getMethodAttr(iterable, Names::__getitem__, method))
+        return Raise<TypeError>("Object not iterable", resultOut);
+
+    return interp->call(SequenceIterator, iterable, resultOut);
+}
+
+bool IteratorNext(Traced<Value> iterator, MutableTraced<Value> resultOut)
+{
+    if (iterator.is<ListIter>())
+        return iterator.as<ListIter>()->next(resultOut);
+    if (iterator.is<TupleIter>())
+        return iterator.as<TupleIter>()->next(resultOut);
+    if (iterator.is<RangeIter>())
+        return iterator.as<RangeIter>()->next(resultOut);
+    if (iterator.is<Zip>())
+        return iterator.as<Zip>()->next(resultOut);
+    if (iterator.is<Map>())
+        return iterator.as<Map>()->next(resultOut);
+    if (iterator.is<Enumerate>())
+        return iterator.as<Enumerate>()->next(resultOut);
+    if (iterator.is<Filter>())
+        return iterator.as<Filter>()->next(resultOut);
+
+    StackMethodAttr method;
+    if (!getSpecialMethodAttr(iterator, Names::__next__, method)) {
+        string message = "'" + iterator.type()->name() +
+                         "' object is not an iterator";
+        return Raise<TypeError>(message, resultOut);
+    }
+
+    if (method.isCallable)
+        return interp->call(method.method, iterator, resultOut);
+    return interp->call(method.method, resultOut);
+}
+
+// Get iterators for all of |iterables| and return them in a tuple.
+static bool GetIterators(NativeArgs iterables, MutableTraced<Value> resultOut)
+{
+    RootVector<Value> iterators(iterables.size());
+    for (size_t i = 0; i < iterables.size(); i++) {
+        if (!GetIterator(iterables[i], iterators.ref(i))) {
+            resultOut = iterators[i];
+            return false;
+        }
+    }
+
+    resultOut = Tuple::get(iterators);
+    return true;
+}
+
+// Get the next value from each of |iterators|.
+static bool NextValues(Traced<Tuple*> iterators, RootVector<Value>& valuesOut,
+                       MutableTraced<Value> resultOut)
+{
+    Stack<Value> iterator;
+    for (size_t i = 0; i < valuesOut.size(); i++) {
+        iterator = iterators->getitem(i);
+        if (!IteratorNext(iterator, valuesOut.ref(i))) {
+            resultOut = valuesOut[i];
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Zip::Zip(Traced<Tuple*> iterators)
+  : Object(ObjectClass), iterators_(iterators)
+{}
+
+void Zip::traceChildren(Tracer& t)
+{
+    Object::traceChildren(t);
+    gc.trace(t, &iterators_);
+}
+
+bool Zip::next(MutableTraced<Value> resultOut)
+{
+    Stack<Tuple*> iterators(iterators_);
+    if (iterators->len() == 0) {
+        resultOut = StopIterationException;
+        return false;
+    }
+
+    RootVector<Value> values(iterators->len());
+    if (!NextValues(iterators, values, resultOut))
+        return false;
+
+    resultOut = Tuple::get(values);
+    return true;
+}
+
+Map::Map(Traced<Value> function, Traced<Tuple*> iterators)
+  : Object(ObjectClass), function_(function), iterators_(iterators)
+{
+    assert(iterators->len() != 0);
+}
+
+void Map::traceChildren(Tracer& t)
+{
+    Object::traceChildren(t);
+    gc.trace(t, &function_);
+    gc.trace(t, &iterators_);
+}
+
+bool Map::next(MutableTraced<Value> resultOut)
+{
+    Stack<Value> function(function_);
+    Stack<Tuple*> iterators(iterators_);
+    if (iterators->len() == 1) {
+        Stack<Value> iterator(iterators->getitem(0));
+        Stack<Value> value;
+        if (!IteratorNext(iterator, value)) {
+            resultOut = value;
+            return false;
+        }
+        return interp->call(function, value, resultOut);
+    }
+
+    RootVector<Value> values(iterators->len());
+    if (!NextValues(iterators, values, resultOut))
+        return false;
+
+    return interp->callWithArgs(function, values, resultOut);
+}
+
+Enumerate::Enumerate(Traced<Value> iterator, Traced<Value> start)
+  : Object(ObjectClass), iterator_(iterator), index_(start)
+{
+    assert(start.isInt());
+}
+
+void Enumerate::traceChildren(Tracer& t)
+{
+    Object::traceChildren(t);
+    gc.trace(t, &iterator_);
+    gc.trace(t, &index_);
+}
+
+bool Enumerate::next(MutableTraced<Value> resultOut)
+{
+    Stack<Value> iterator(iterator_);
+    Stack<Value> value;
+    if (!IteratorNext(iterator, value)) {
+        resultOut = value;
+        return false;
+    }
+
+    RootVector<Value> pair(2);
+    pair[0] = index_;
+    pair[1] = value;
+    resultOut = Tuple::get(pair);
+
+    if (index_.isInt32())
+        index_ = Integer::get(int64_t(index_.asInt32()) + 1);
+    else
+        index_ = Integer::get(mpz_class(index_.as<Integer>()->value() + 1));
+    return true;
+}
+
+Filter::Filter(Traced<Value> function, Traced<Value> iterator)
+  : Object(ObjectClass), function_(function), iterator_(iterator)
+{}
+
+void Filter::traceChildren(Tracer& t)
+{
+    Object::traceChildren(t);
+    gc.trace(t, &function_);
+    gc.trace(t, &iterator_);
+}
+
+bool Filter::next(MutableTraced<Value> resultOut)
+{
+    Stack<Value> function(function_);
+    Stack<Value> iterator(iterator_);
+    Stack<Value> result;
+    for (;;) {
+        if (!IteratorNext(iterator, resultOut))
+            return false;
+
+        if (function == Value(None)) {
+            if (Value::IsTrue(resultOut))
+                return true;
+            continue;
+        }
+
+        if (!interp->call(function, resultOut, result)) {
+            resultOut = result;
+            return false;
+        }
+        if (Value::IsTrue(result))
+            return true;
+    }
+}
+
+static bool zip_new(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], Class::ObjectClass, resultOut))
+        return false;
+
+    TracedVector<Value> iterables(args, 1, args.size() - 1);
+    if (!GetIterators(iterables, resultOut))
+        return false;
+
+    Stack<Tuple*> iterators(resultOut.as<Tuple>());
+    resultOut = gc.create<Zip>(iterators);
+    return true;
+}
+
+static bool map_new(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], Class::ObjectClass, resultOut))
+        return false;
+
+    if (args.size() < 3)
+        return Raise<TypeError>("map() must have at least two arguments",
+                                resultOut);
+
+    TracedVector<Value> iterables(args, 2, args.size() - 2);
+    if (!GetIterators(iterables, resultOut))
+        return false;
+
+    Stack<Tuple*> iterators(resultOut.as<Tuple>());
+    resultOut = gc.create<Map>(args[1], iterators);
+    return true;
+}
+
+static bool enumerate_new(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], Class::ObjectClass, resultOut))
+        return false;
+
+    if (args.size() < 2)
+        return Raise<TypeError>("enumerate() missing required argument",
+                                resultOut);
+
+    Stack<Value> start(args.size() == 3 ? args[2] : Value(0));
+    if (!start.isInt())
+        return Raise<TypeError>("enumerate() start must be an integer",
+                                resultOut);
+
+    Stack<Value> iterator;
+    if (!GetIterator(args[1], iterator)) {
+        resultOut = iterator;
+        return false;
+    }
+
+    resultOut = gc.create<Enumerate>(iterator, start);
+    return true;
+}
+
+static bool filter_new(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], Class::ObjectClass, resultOut))
+        return false;
+
+    if (args.size() != 3)
+        return Raise<TypeError>("filter expected 2 arguments", resultOut);
+
+    Stack<Value> iterator;
+    if (!GetIterator(args[2], iterator)) {
+        resultOut = iterator;
+        return false;
+    }
+
+    resultOut = gc.create<Filter>(args[1], iterator);
+    return true;
+}
+
+static bool iterator_iter(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    resultOut = args[0];
+    return true;
+}
+
+template <typename T>
+static bool iterator_next(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    return args[0].as<T>()->next(resultOut);
+}
+
+template <typename T>
+static Class* createIteratorClass(const string& name, NativeFunc newFunc,
+                                  unsigned maxArgs)
+{
+    Stack<Class*> cls(Class::createNative(name, newFunc, maxArgs));
+    initNativeMethod(cls, "__iter__", iterator_iter, 1);
+    initNativeMethod(cls, "__next__", iterator_next<T>, 1);
+    return cls;
+}
+
+void Zip::init()
+{
+    ObjectClass.init(createIteratorClass<Zip>("zip", zip_new, UINT_MAX));
+}
+
+void Map::init()
+{
+    ObjectClass.init(createIteratorClass<Map>("map", map_new, UINT_MAX));
+}
+
+void Enumerate::init()
+{
+    ObjectClass.init(
+        createIteratorClass<Enumerate>("enumerate", enumerate_new, 3));
+}
+
+void Filter::init()
+{
+    ObjectClass.init(createIteratorClass<Filter>("filter", filter_new, 3));
+}
+
+void initIterators()
+{
+    Zip::init();
+    Map::init();
+    Enumerate::init();
+    Filter::init();
+}
@@ -0,0 +1,85 @@
+#ifndef __ITERATOR_H__
+#define __ITERATOR_H__
+
+#include "object.h"
+
+struct Tuple;
+
+// Get an iterator for |iterable| in the same way as the iter() builtin.
+extern bool GetIterator(Traced<Value> iterable, MutableTraced<Value> resultOut);
+
+// Get the next value from |iterator|.  Builtin iterators are advanced directly
+// and others by calling their __next__ method.  When the iterator is exhausted
+// this returns false with a StopIteration exception in |resultOut|.
+extern bool IteratorNext(Traced<Value> iterator, MutableTraced<Value> resultOut);
+
+// Iterator returned by zip().
+struct Zip : public Object
+{
+    static void init();
+    static GlobalRoot<Class*> ObjectClass;
+
+    Zip(Traced<Tuple*> iterators);
+
+    void traceChildren(Tracer& t) override;
+
+    bool next(MutableTraced<Value> resultOut);
+
+  private:
+    Heap<Tuple*> iterators_;
+};
+
+// Iterator returned by map().
+struct Map : public Object
+{
+    static void init();
+    static GlobalRoot<Class*> ObjectClass;
+
+    Map(Traced<Value> function, Traced<Tuple*> iterators);
+
+    void traceChildren(Tracer& t) override;
+
+    bool next(MutableTraced<Value> resultOut);
+
+  private:
+    Heap<Value> function_;
+    Heap<Tuple*> iterators_;
+};
+
+// Iterator returned by enumerate().
+struct Enumerate : public Object
+{
+    static void init();
+    static GlobalRoot<Class*> ObjectClass;
+
+    Enumerate(Traced<Value> iterator, Traced<Value> start);
+
+    void traceChildren(Tracer& t) override;
+
+    bool next(MutableTraced<Value> resultOut);
+
+  private:
+    Heap<Value> iterator_;
+    Heap<Value> index_;
+};
+
+// Iterator returned by filter().
+struct Filter : public Object
+{
+    static void init();
+    static GlobalRoot<Class*> ObjectClass;
+
+    Filter(Traced<Value> function, Traced<Value> iterator);
+
+    void traceChildren(Tracer& t) override;
+
+    bool next(MutableTraced<Value> resultOut);
+
+  private:
+    Heap<Value> function_;
+    Heap<Value> iterator_;
+};
+
+extern void initIterators();
+
+#endif
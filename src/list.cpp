@@ -7,28 +7,13 @@
 #include "numeric.h"
 #include "singletons.h"
 #include "slice.h"
+#include "sort.h"
+#include "string.h"
 
 #include "value-inl.h"
 
 #include <algorithm>
-
-template <typename T>
-struct ListIterImpl : public Object
-{
-    static void init();
-    static GlobalRoot<Class*> ObjectClass;
-
-    ListIterImpl(Traced<T*> list);
-
-    void traceChildren(Tracer& t) override;
-
-    bool iter(MutableTraced<Value> resultOut);
-    bool next(MutableTraced<Value> resultOut);
-
-  private:
-    Heap<T*> list_;
-    int index_;
-};
+#include <cstring>
 
 GlobalRoot<Class*> Tuple::ObjectClass;
 GlobalRoot<Tuple*> Tuple::Empty;
@@ -39,9 +24,6 @@ GlobalRoot<Class*> ListIterImpl<T>::ObjectClass;
 template struct ListIterImpl<Tuple>;
 template struct ListIterImpl<List>;
 
-typedef ListIterImpl<Tuple> TupleIter;
-typedef ListIterImpl<List> ListIter;
-
 inline static size_t allocSize(size_t size)
 {
     return sizeof(Tuple) + size * sizeof(Heap<Value>);
@@ -86,7 +68,7 @@ Tuple::Tuple(size_t size, Traced<Class*> cls)
     assert(cls->isDerivedFrom(ObjectClass));
 #ifdef DEBUG
     for (unsigned i = 0; i < size; i++)
-        elements_[i] = UninitializedSlot;
+        elements_[i] = Value(UninitializedSlot);
 #endif
 }
 
@@ -119,7 +101,7 @@ void Tuple::print(ostream& s) const
     for (unsigned i = 0; i < size_; ++i) {
         if (i != 0)
             s << ", ";
-        s << elements_[i];
+        s << elements_[i].get();
     }
     if (size_ == 1)
             s << ",";
@@ -132,69 +114,227 @@ void Tuple::traceChildren(Tracer& t)
         gc.trace(t, &elements_[i]);
 }
 
+/* static */ ListStore* ListStore::get(size_t bytes)
+{
+    // Make use of any space left over in the cell's size class.
+    size_t size = GC::allocatedSize(sizeof(ListStore) + bytes);
+    return gc.createSized<ListStore>(size, size - sizeof(ListStore));
+}
+
+/* static */ List* List::get(const TracedVector<Value>& values)
+{
+    Stack<List*> list(getUninitialised(values.size()));
+    for (size_t i = 0; i < values.size(); i++)
+        list->initElement(i, values[i]);
+    return list;
+}
+
 /* static */ List* List::get(Traced<Class*> cls, Traced<Tuple*> init)
 {
-    return gc.create<List>(cls, init);
+    Stack<List*> list(getUninitialised(init->len(), cls));
+    for (int32_t i = 0; i < init->len(); i++)
+        list->initElement(i, init->getitem(i));
+    return list;
 }
 
 /* static */ List* List::get(Traced<Class*> cls, Traced<List*> init)
 {
-    return gc.create<List>(cls, init);
+    Stack<List*> list(gc.create<List>(cls));
+    list->copyElements(init, 0, init->length_, 1);
+    return list;
 }
 
-/* static */ List* List::getUninitialised(size_t size, Traced<Class*> cls)
+/* static */ List* List::getSlice(Traced<List*> list, int32_t start,
+                                  int32_t count, int32_t step)
 {
-    return gc.create<List>(size, cls);
+    Stack<List*> result(gc.create<List>(ObjectClass));
+    result->copyElements(list, start, count, step);
+    return result;
 }
 
-List::List(const TracedVector<Value>& values)
-  : Object(ObjectClass), elements_(values.size())
-{
-    for (unsigned i = 0; i < values.size(); ++i)
-        elements_[i] = values[i];
+template <typename T>
+static void CopyElements(T* dest, const T* src, size_t count, int32_t step)
+{
+    for (size_t i = 0; i < count; i++)
+        dest[i] = src[ptrdiff_t(i) * step];
+}
+
+void List::copyElements(Traced<List*> source, int32_t start, int32_t count,
+                        int32_t step)
+{
+    assert(length_ == 0 && !store_);
+    if (count == 0)
+        return;
+
+    // Copy the elements directly, keeping the same strategy.
+    Stack<List*> self(this);
+    Strategy strategy = source->strategy_;
+    size_t size = ElementSize(strategy);
+    Stack<ListStore*> store(ListStore::get(count * size));
+    switch (strategy) {
+      case Strategy::Int32:
+        CopyElements(store->elements<int32_t>(),
+                     source->store_->elements<int32_t>() + start, count, step);
+        break;
+      case Strategy::Double:
+        CopyElements(store->elements<double>(),
+                     source->store_->elements<double>() + start, count, step);
+        break;
+      default:
+        CopyElements(store->elements<Heap<Value>>(),
+                     source->store_->elements<Heap<Value>>() + start, count,
+                     step);
+        break;
+    }
+    strategy_ = strategy;
+    capacity_ = store->bytes() / size;
+    store_ = store;
+    length_ = count;
 }
 
-List::List(size_t size, Traced<Class*> cls)
-  : Object(ObjectClass)
+/* static */ List* List::getUninitialised(size_t size, Traced<Class*> cls)
 {
-    assert(cls->isDerivedFrom(ObjectClass));
-    elements_.reserve(size);
+    // Storage is allocated when the first element is added and the strategy
+    // is known.
+    List* list = gc.create<List>(cls);
+    list->reserved_ = size;
+    return list;
 }
 
-List::List(Traced<Class*> cls, Traced<List*> init)
-  : Object(cls), elements_(init->elements_)
+List::List(Traced<Class*> cls)
+  : Object(cls),
+    strategy_(Strategy::Int32),
+    length_(0),
+    capacity_(0),
+    reserved_(0),
+    store_(nullptr)
 {
     assert(cls->isDerivedFrom(ObjectClass));
 }
 
-List::List(Traced<Class*> cls, Traced<Tuple*> init)
-  : Object(cls), elements_(init->len())
+/* static */ size_t List::ElementSize(Strategy strategy)
 {
-    assert(cls->isDerivedFrom(ObjectClass));
-    for (size_t i = 0; i < elements_.size(); ++i)
-        elements_[i] = init->getitem(i);
+    switch (strategy) {
+      case Strategy::Int32:
+        return sizeof(int32_t);
+      case Strategy::Double:
+        return sizeof(double);
+      default:
+        return sizeof(Heap<Value>);
+    }
 }
 
 void List::initElement(size_t index, const Value& value)
 {
-    assert(elements_.size() == index);
-    elements_.push_back_reserved(value);
+    assert(length_ == index);
+    push(value);
+}
+
+void List::push(Value value)
+{
+    if (!canStore(value) || length_ == capacity_)
+        prepareStore(value, length_ + 1);
+    storeElement(length_, value);
+    length_++;
+}
+
+void List::setitemSlow(int32_t index, Value value)
+{
+    prepareStore(value, length_);
+    storeElement(index, value);
+}
+
+void List::prepareStore(Value valueArg, size_t count)
+{
+    Strategy strategy = strategy_;
+    if (length_ == 0)
+        strategy = StrategyFor(valueArg);
+    else if (!canStore(valueArg))
+        strategy = Strategy::Generic;
+
+    Stack<Value> value(valueArg);
+    prepareStore(strategy, count);
+}
+
+void List::prepareStore(Strategy strategy, size_t count)
+{
+    // An empty store can be reused for any strategy.
+    size_t elementSize = ElementSize(strategy);
+    size_t available = 0;
+    if (store_ && (strategy == strategy_ || length_ == 0))
+        available = store_->bytes() / elementSize;
+    if (count <= available) {
+        strategy_ = strategy;
+        capacity_ = available;
+        return;
+    }
+
+    size_t newCapacity = max(count, size_t(max(reserved_, capacity_)));
+    if (count > capacity_)
+        newCapacity = max(newCapacity, size_t(capacity_) * 2);
+    newCapacity = max(newCapacity, size_t(4));
+    reserved_ = 0;
+
+    Stack<List*> self(this);
+    Stack<ListStore*> store(ListStore::get(newCapacity * elementSize));
+    if (strategy == strategy_) {
+        if (strategy == Strategy::Generic) {
+            CopyElements(store->elements<Heap<Value>>(),
+                         store_->elements<Heap<Value>>(), length_, 1);
+        } else if (length_) {
+            memcpy(store->elements<uint8_t>(), store_->elements<uint8_t>(),
+                   length_ * elementSize);
+        }
+    } else {
+        // Switching from an unboxed strategy to generic values.
+        assert(strategy == Strategy::Generic || length_ == 0);
+        Heap<Value>* dest = store->elements<Heap<Value>>();
+        for (size_t i = 0; i < length_; i++)
+            dest[i] = getitem(i);
+    }
+
+    strategy_ = strategy;
+    capacity_ = store->bytes() / elementSize;
+    store_ = store;
+}
+
+void List::moveElements(size_t dest, size_t src, size_t count)
+{
+    assert(dest + count <= capacity_ && src + count <= capacity_);
+    if (strategy_ == Strategy::Generic) {
+        Heap<Value>* elements = store_->elements<Heap<Value>>();
+        if (dest < src)
+            copy(elements + src, elements + src + count, elements + dest);
+        else
+            copy_backward(elements + src, elements + src + count,
+                          elements + dest + count);
+    } else {
+        size_t size = ElementSize(strategy_);
+        uint8_t* elements = store_->elements<uint8_t>();
+        memmove(elements + dest * size, elements + src * size, count * size);
+    }
 }
 
 void List::print(ostream& s) const
 {
     s << "[";
-    for (unsigned i = 0; i < elements_.size(); ++i) {
+    for (unsigned i = 0; i < length_; ++i) {
         if (i != 0)
             s << ", ";
-        s << elements_[i];
+        s << getitem(i);
     }
     s << "]";
 }
 
 void List::traceChildren(Tracer& t)
 {
-    gc.traceVector(t, &elements_);
+    Object::traceChildren(t);
+    gc.trace(t, &store_);
+    if (strategy_ == Strategy::Generic) {
+        Heap<Value>* elements = store_->elements<Heap<Value>>();
+        for (size_t i = 0; i < length_; i++)
+            gc.trace(t, &elements[i]);
+    }
 }
 
 static bool RaiseOutOfRange(MutableTraced<Value> resultOut)
@@ -223,12 +363,6 @@ GetIndex(T* self, Traced<Value> index,
     return true;
 }
 
-void List::setitem(int32_t index, Value value)
-{
-    assert(index < elements_.size());
-    elements_[index] = value;
-}
-
 bool List::delitem(Traced<Value> index, MutableTraced<Value> resultOut)
 {
 
@@ -236,43 +370,222 @@ bool List::delitem(Traced<Value> index, MutableTraced<Value> resultOut)
     if (!GetIndex(this, index, &i, resultOut))
         return false;
 
-    elements_.erase(elements_.begin() + i);
+    moveElements(i, i + 1, length_ - i - 1);
+    length_--;
     resultOut = None;
     return true;
 }
 
-void List::replaceitems(int32_t start, int32_t count, Traced<List*> list)
+void List::replaceitems(int32_t start, int32_t count, Traced<List*> listArg)
 {
-    // todo: could be more clever here.
     assert(start + count <= len());
-    auto i = elements_.begin() + start;
-    elements_.erase(i, i + count);
-    elements_.insert(i, list->elements_.begin(), list->elements_.end());
+    Stack<List*> self(this);
+    Stack<List*> list(listArg);
+    if (list == self)
+        list = getSlice(list, 0, length_, 1);
+
+    size_t added = list->length_;
+    size_t tail = length_ - start - count;
+    size_t length = length_ - count + added;
+    if (added == 0) {
+        moveElements(start, start + count, tail);
+        length_ = length;
+        return;
+    }
+
+    // Replacing everything lets the new elements pick the strategy.
+    if (length_ == size_t(count))
+        length_ = 0;
+
+    Strategy strategy = Strategy::Generic;
+    if (length_ == 0 || strategy_ == list->strategy_)
+        strategy = list->strategy_;
+    prepareStore(strategy, max(length, size_t(length_)));
+
+    moveElements(start + added, start + count, tail);
+    switch (strategy_ == list->strategy_ ? strategy_ : Strategy::Generic) {
+      case Strategy::Int32:
+        CopyElements(store_->elements<int32_t>() + start,
+                     list->store_->elements<int32_t>(), added, 1);
+        break;
+      case Strategy::Double:
+        CopyElements(store_->elements<double>() + start,
+                     list->store_->elements<double>(), added, 1);
+        break;
+      default:
+        for (size_t i = 0; i < added; i++)
+            storeElement(start + i, list->getitem(i));
+        break;
+    }
+    length_ = length;
 }
 
 void List::append(Traced<Value> element)
 {
-    elements_.push_back(element);
+    push(element);
 }
 
-static bool compareElements(Value aArg, Value bArg)
+// Sort with the order given by less, or the opposite order if reverse is set.
+// Both are stable, which gives the same result as CPython's approach of
+// reversing the list before and after sorting.
+template <typename T, typename Less>
+static void SortInOrder(T* data, size_t length, T* buffer, bool reverse,
+                        Less less)
 {
-    Stack<Value> a(aArg);
-    Stack<Value> b(bArg);
-    Stack<Value> compare;
-    Stack<Value> result;
-    if (!a.maybeGetAttr(Names::compareMethod[CompareLT], compare))
-        ThrowException<TypeError>("Object has no __lt__ method");
+    if (reverse) {
+        TimSort(data, length, buffer,
+                [&] (const T& a, const T& b) { return less(b, a); });
+    } else {
+        TimSort(data, length, buffer, less);
+    }
+}
+
+template <typename T>
+static void SortUnboxed(T* data, size_t length, bool reverse)
+{
+    vector<T> buffer(length / 2);
+    SortInOrder(data, length, buffer.data(), reverse,
+                [] (T a, T b) { return a < b; });
+}
 
-    if (!interp->call(compare, a, b, result))
-        throw PythonException(result);
+// Sort the indices of a vector of keys by comparing the keys with less.
+template <typename Keys, typename Less>
+static void SortIndices(vector<uint32_t>& indices, const Keys& keys,
+                        bool reverse, Less less)
+{
+    vector<uint32_t> buffer(indices.size() / 2);
+    SortInOrder(indices.data(), indices.size(), buffer.data(), reverse,
+                [&] (uint32_t a, uint32_t b) {
+                    return less(keys[a], keys[b]);
+                });
+}
 
-    return Value::IsTrue(result);
+// Get the keys as one of the unboxed types if they are all of that type.
+template <typename K, typename F>
+static bool ExtractKeys(const RootVector<Value>& keys, vector<K>& keysOut,
+                        F&& extract)
+{
+    keysOut.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (!extract(keys[i], keysOut[i]))
+            return false;
+    }
+    return true;
 }
 
-void List::sort()
+static bool SortKeyIndices(const RootVector<Value>& keys, bool reverse,
+                           vector<uint32_t>& indices,
+                           MutableTraced<Value> resultOut)
 {
-    ::sort(elements_.begin(), elements_.end(), compareElements);
+    vector<int32_t> ints;
+    if (ExtractKeys(keys, ints, [] (Value key, int32_t& out) {
+        out = key.isInt32() ? key.asInt32() : 0;
+        return key.isInt32();
+    })) {
+        SortIndices(indices, ints, reverse,
+                    [] (int32_t a, int32_t b) { return a < b; });
+        return true;
+    }
+
+    // Any int32 can be represented exactly as a double.
+    vector<double> numbers;
+    if (ExtractKeys(keys, numbers, [] (Value key, double& out) {
+        if (key.isInt32())
+            out = key.asInt32();
+        else if (key.isDouble())
+            out = key.asDouble();
+        else
+            return false;
+        return true;
+    })) {
+        SortIndices(indices, numbers, reverse,
+                    [] (double a, double b) { return a < b; });
+        return true;
+    }
+
+    // The strings are kept alive by keys, and comparing them can't GC.
+    vector<String*> strings;
+    if (ExtractKeys(keys, strings, [] (Value key, String*& out) {
+        out = key.is<String>() ? key.as<String>() : nullptr;
+        return out != nullptr;
+    })) {
+        SortIndices(indices, strings, reverse,
+                    [] (String* a, String* b) { return a->compare(b) < 0; });
+        return true;
+    }
+
+    // Fall back to using the < operator.  After an error all comparisons
+    // return false so that the sort finishes quickly.
+    bool failed = false;
+    SortIndices(indices, keys, reverse, [&] (Value a, Value b) {
+        if (failed)
+            return false;
+
+        Stack<Value> left(a);
+        Stack<Value> right(b);
+        bool result;
+        if (!CompareValues<CompareLT>(left, right, result, resultOut)) {
+            failed = true;
+            return false;
+        }
+        return result;
+    });
+    return !failed;
+}
+
+bool List::sort(Traced<Value> key, bool reverse,
+                MutableTraced<Value> resultOut)
+{
+    Stack<List*> self(this);
+    size_t length = length_;
+    resultOut = None;
+    if (length == 0)
+        return true;
+
+    if (key.isNone() && strategy_ == Strategy::Int32) {
+        SortUnboxed(store_->elements<int32_t>(), length, reverse);
+        return true;
+    }
+    if (key.isNone() && strategy_ == Strategy::Double) {
+        SortUnboxed(store_->elements<double>(), length, reverse);
+        return true;
+    }
+
+    // Sort the positions of the elements, computing each key only once.
+    RootVector<Value> elements(length);
+    for (size_t i = 0; i < length; i++)
+        elements[i] = getitem(i);
+
+    RootVector<Value> keys;
+    if (!key.isNone()) {
+        keys.resize(length);
+        Stack<Value> element;
+        Stack<Value> result;
+        for (size_t i = 0; i < length; i++) {
+            element = elements[i];
+            if (!interp->call(key, element, result)) {
+                resultOut = result;
+                return false;
+            }
+            keys[i] = result;
+        }
+    }
+
+    vector<uint32_t> indices(length);
+    for (size_t i = 0; i < length; i++)
+        indices[i] = i;
+    if (!SortKeyIndices(key.isNone() ? elements : keys, reverse, indices,
+                        resultOut))
+    {
+        return false;
+    }
+
+    if (length_ != length)
+        return Raise<ValueError>("list modified during sort", resultOut);
+
+    for (size_t i = 0; i < length; i++)
+        setitem(i, elements[indices[i]]);
+    return true;
 }
 
 template <typename T>
@@ -362,6 +675,27 @@ static bool generic_len(NativeArgs args,
 }
 
 
+static Tuple* GetSlice(Tuple* tupleArg, int32_t start, int32_t count,
+                       int32_t step)
+{
+    Stack<Tuple*> tuple(tupleArg);
+    Stack<Tuple*> result(Tuple::getUninitialised(count));
+    int32_t src = start;
+    for (size_t i = 0; i < count; i++) {
+        assert(src < tuple->len());
+        result->initElement(i, tuple->getitem(src));
+        src += step;
+    }
+    return result;
+}
+
+static List* GetSlice(List* listArg, int32_t start, int32_t count,
+                      int32_t step)
+{
+    Stack<List*> list(listArg);
+    return List::getSlice(list, start, count, step);
+}
+
 template <class T>
 static bool generic_getitem(NativeArgs args,
                             MutableTraced<Value> resultOut)
@@ -384,15 +718,7 @@ static bool generic_getitem(NativeArgs args,
             return false;
         }
 
-        Stack<T*> result(T::getUninitialised(count));
-        int32_t src = start;
-        for (size_t i = 0; i < count; i++) {
-            assert(src < self->len());
-            result->initElement(i, self->getitem(src));
-            src += step;
-        }
-
-        resultOut = Value(result);
+        resultOut = GetSlice(self.get(), start, count, step);
         return true;
     } else {
         return Raise<TypeError>("indices must be integers or slices", resultOut);
@@ -524,9 +850,14 @@ static bool list_append(NativeArgs args, MutableTraced<Value> resultOut)
 
 static bool list_sort(NativeArgs args, MutableTraced<Value> resultOut)
 {
-    args[0].as<List>()->sort();
-    resultOut = None;
-    return true;
+    // Keyword arguments are passed positionally by the wrapper in
+    // internals/internal.py.
+    Stack<List*> self(args[0].as<List>());
+    Stack<Value> key(None);
+    if (args.size() > 1)
+        key = args[1];
+    bool reverse = args.size() > 2 && Value::IsTrue(args[2]);
+    return self->sort(key, reverse, resultOut);
 }
 
 template <class T>
@@ -541,10 +872,41 @@ static void generic_initNatives(Traced<Class*> cls)
     // __eq__ and __ne__ are supplied by internals/internal.py
 }
 
+size_t Tuple::hash()
+{
+    // Combine the element hashes in the same way as CPython.
+    Stack<Tuple*> self(this);
+    size_t hash = 0x345678;
+    size_t mult = 1000003;
+    Stack<Value> element;
+    for (int32_t i = 0; i < size_; i++) {
+        element = elements_[i];
+        hash = (hash ^ ValueHash()(element)) * mult;
+        mult += 82520 + 2 * (size_ - i);
+    }
+    return hash + 97531;
+}
+
+static bool tuple_hash(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    size_t hash;
+    try {
+        Stack<Tuple*> tuple(args[0].as<Tuple>());
+        hash = tuple->hash();
+    } catch (const PythonException& e) {
+        resultOut = e.result();
+        return false;
+    }
+
+    resultOut = Integer::get(int64_t(hash));
+    return true;
+}
+
 void Tuple::init()
 {
     ObjectClass.init(Class::createNative("tuple", generic_new<Tuple>, 2));
     generic_initNatives<Tuple>(ObjectClass);
+    initNativeMethod(ObjectClass, "__hash__", tuple_hash, 1);
     Empty.init(gc.createSized<Tuple>(allocSize(0), EmptyValueArray));
 }
 
@@ -555,7 +917,7 @@ void List::init()
     initNativeMethod(ObjectClass, "__setitem__", list_setitem, 3);
     initNativeMethod(ObjectClass, "__delitem__", list_delitem, 2);
     initNativeMethod(ObjectClass, "append", list_append, 2);
-    initNativeMethod(ObjectClass, "sort", list_sort, 1);
+    initNativeMethod(ObjectClass, "sort", list_sort, 1, 3);
 }
 
 template <typename T>
@@ -29,6 +29,9 @@ struct Tuple : public Object
         return elements_[index];
     }
 
+    // Hash the elements.  This can call __hash__ and throw PythonException.
+    size_t hash();
+
   private:
     friend struct GC;
     Tuple(const TracedVector<Value>& values);
@@ -40,41 +43,167 @@ struct Tuple : public Object
     Heap<Value> elements_[0];
 };
 
+// Untyped storage for the elements of a list.  The list knows what kind of
+// elements are stored here and traces them itself.
+struct ListStore : public Cell
+{
+    static ListStore* get(size_t bytes);
+
+    size_t bytes() const { return bytes_; }
+
+    template <typename T>
+    T* elements() { return reinterpret_cast<T*>(data_); }
+
+  private:
+    friend struct GC;
+    ListStore(size_t bytes) : bytes_(bytes) {}
+
+    size_t bytes_;
+    uint64_t data_[0];
+};
+
+// A list stores its elements unboxed when they are all int32 values or all
+// doubles, and falls back to storing generic values the first time an element
+// of a different kind is stored.  An empty list picks its strategy again when
+// the next element is added.
 struct List : public Object
 {
     static GlobalRoot<Class*> ObjectClass;
 
     static void init();
 
+    static List* get(const TracedVector<Value>& values);
     static List* get(Traced<Class*> cls, Traced<Tuple*> init);
     static List* get(Traced<Class*> cls, Traced<List*> init);
 
     static List* getUninitialised(size_t size, Traced<Class*> cls = ObjectClass);
+
+    // Get a new list containing count elements of list, starting at start and
+    // separated by step.
+    static List* getSlice(Traced<List*> list, int32_t start, int32_t count,
+                          int32_t step);
     void initElement(size_t index, const Value& value);
 
     void print(ostream& os) const override;
     void traceChildren(Tracer& t) override;
 
-    int32_t len() const { return (int32_t)elements_.size(); }
-    Value getitem(size_t index) const { return elements_[index]; }
-    const HeapVector<Value>& elements() const { return elements_; }
+    int32_t len() const { return length_; }
+
+    Value getitem(size_t index) const {
+        assert(index < length_);
+        switch (strategy_) {
+          case Strategy::Int32:
+            return Value(store_->elements<int32_t>()[index]);
+          case Strategy::Double:
+            return Value(store_->elements<double>()[index]);
+          default:
+            return store_->elements<Heap<Value>>()[index];
+        }
+    }
+
+    void setitem(int32_t index, Value value) {
+        assert(size_t(index) < length_);
+        if (!canStore(value)) {
+            setitemSlow(index, value);
+            return;
+        }
+        storeElement(index, value);
+    }
 
-    void setitem(int32_t index, Value value);
     bool delitem(Traced<Value> index, MutableTraced<Value> resultOut);
     void replaceitems(int32_t start, int32_t count, Traced<List*> list);
     void append(Traced<Value> element);
-    void sort();
+
+    // Sort the list in place.  If key is not None it is called once for each
+    // element and the results are compared instead.
+    bool sort(Traced<Value> key, bool reverse, MutableTraced<Value> resultOut);
 
   private:
     friend struct GC;
-    List(const TracedVector<Value>& values);
-    List(size_t size, Traced<Class*> cls);
-    List(Traced<Class*> cls, Traced<Tuple*> init);
-    List(Traced<Class*> cls, Traced<List*> init);
 
-    HeapVector<Value> elements_;
+    enum class Strategy : uint8_t
+    {
+        Int32,
+        Double,
+        Generic
+    };
+
+    List(Traced<Class*> cls);
+
+    static Strategy StrategyFor(Value value) {
+        if (value.isInt32())
+            return Strategy::Int32;
+        if (value.isDouble())
+            return Strategy::Double;
+        return Strategy::Generic;
+    }
+
+    static size_t ElementSize(Strategy strategy);
+
+    bool canStore(Value value) const {
+        return strategy_ == Strategy::Generic ||
+               strategy_ == StrategyFor(value);
+    }
+
+    void storeElement(size_t index, Value value) {
+        assert(canStore(value));
+        switch (strategy_) {
+          case Strategy::Int32:
+            store_->elements<int32_t>()[index] = value.asInt32();
+            break;
+          case Strategy::Double:
+            store_->elements<double>()[index] = value.asDouble();
+            break;
+          default:
+            store_->elements<Heap<Value>>()[index] = value;
+            break;
+        }
+    }
+
+    void setitemSlow(int32_t index, Value value);
+    void push(Value value);
+
+    // Make room for count elements and ensure value can be stored, changing
+    // strategy if necessary.  This can GC.
+    void prepareStore(Value value, size_t count);
+    void prepareStore(Strategy strategy, size_t count);
+
+    void copyElements(Traced<List*> source, int32_t start, int32_t count,
+                      int32_t step);
+
+    void moveElements(size_t dest, size_t src, size_t count);
+
+    Strategy strategy_;
+    uint32_t length_;
+    uint32_t capacity_;
+    uint32_t reserved_;
+    Heap<ListStore*> store_;
 };
 
+template <typename T>
+struct ListIterImpl : public Object
+{
+    static void init();
+    static GlobalRoot<Class*> ObjectClass;
+
+    ListIterImpl(Traced<T*> list);
+
+    void traceChildren(Tracer& t) override;
+
+    bool iter(MutableTraced<Value> resultOut);
+    bool next(MutableTraced<Value> resultOut);
+
+  private:
+    Heap<T*> list_;
+    int index_;
+};
+
+extern template struct ListIterImpl<Tuple>;
+extern template struct ListIterImpl<List>;
+
+typedef ListIterImpl<Tuple> TupleIter;
+typedef ListIterImpl<List> ListIter;
+
 extern void initList();
 
 #endif
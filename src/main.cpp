@@ -41,6 +41,11 @@ char *readOneLine()
     return lineRead;
 }
 
+bool testsMayAbort()
+{
+    return false;
+}
+
 void maybeAbortTests(string what)
 {}
 
@@ -65,10 +70,10 @@ static int runProgram(const char* filename, int arg_count, const char* args[])
     Stack<Env*> topLevel(createTopLevel());
     RootVector<Value> argStrings(arg_count);
     for (int i = 0 ; i < arg_count ; ++i)
-        argStrings[i] = gc.create<String>(args[i]);
-    Stack<Value> argv(gc.create<List>(argStrings));
+        argStrings[i] = String::get(args[i]);
+    Stack<Value> argv(List::get(argStrings));
     Module::Sys->setAttr(Names::argv, argv);
-    Stack<Value> main(gc.create<String>("__main__"));
+    Stack<Value> main(String::get("__main__"));
     topLevel->setAttr(Names::__name__, main);
     if (!execModule(readFile(filename), filename, topLevel))
         return EX_SOFTWARE;
@@ -78,7 +83,7 @@ static int runProgram(const char* filename, int arg_count, const char* args[])
 
 static int runModule(const char* name, int arg_count, const char* args[])
 {
-    Stack<String*> nameStr(gc.create<String>(name));
+    Stack<String*> nameStr(String::get(name));
     Stack<Value> result;
     bool ok = interp->call(LoadModule, nameStr, result);
     if (!ok) {
@@ -124,6 +129,7 @@ const char* usageMessage =
     "  -z N               -- perform GC every N allocations\n"
 #endif
     "  -sg                -- print GC stats\n"
+    "  -se                -- print exception stats\n"
 #ifdef DEBUG
     "  -si                -- print instruction count stats\n"
 #endif
@@ -170,6 +176,8 @@ int main(int argc, const char* argv[])
 #endif
         else if (strcmp("-sg", opt) == 0)
             logGCStats = true;
+        else if (strcmp("-se", opt) == 0)
+            logExceptionStats = true;
 #ifdef DEBUG
         else if (strcmp("-si", opt) == 0)
             logInstrCounts = true;
@@ -2,7 +2,9 @@
 
 #include "dict.h"
 #include "exception.h"
+#include "interp.h"
 #include "list.h"
+#include "numeric.h"
 
 #include "value-inl.h"
 
@@ -13,6 +15,29 @@ GlobalRoot<Dict*> Module::Cache;
 GlobalRoot<Class*> Package::ObjectClass;
 GlobalRoot<Layout*> Package::InitialLayout;
 
+static bool sys_getrecursionlimit(NativeArgs args,
+                                  MutableTraced<Value> resultOut)
+{
+    resultOut = Integer::get(interp->recursionLimit());
+    return true;
+}
+
+static bool sys_setrecursionlimit(NativeArgs args,
+                                  MutableTraced<Value> resultOut)
+{
+    if (!args[0].isInt())
+        return Raise<TypeError>("an integer is required", resultOut);
+
+    int32_t limit;
+    if (!args[0].toInt32(limit) || limit < 1)
+        return Raise<ValueError>("recursion limit must be greater or equal "
+                                 "than 1", resultOut);
+
+    interp->setRecursionLimit(limit);
+    resultOut = None;
+    return true;
+}
+
 void Module::Init()
 {
     ObjectClass.init(Class::createNative("module", New, 2, Env::ObjectClass));
@@ -28,13 +53,16 @@ void Module::Init()
     Sys->setAttr(Names::modules, Cache);
 
     // todo: get this from command line or env
-    Stack<String*> defaultPath(gc.create<String>("lib"));
+    Stack<String*> defaultPath(String::get("lib"));
 
     Stack<List*> path(List::getUninitialised(1));
     path->initElement(0, Value(defaultPath));
     Stack<Value> value(path);
     Sys->setAttr(Names::path, value);
 
+    initNativeMethod(Sys, "getrecursionlimit", sys_getrecursionlimit, 0);
+    initNativeMethod(Sys, "setrecursionlimit", sys_setrecursionlimit, 1);
+
     Stack<Value> key(name);
     value = Sys;
     Cache->setitem(key, value);
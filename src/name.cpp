@@ -92,8 +92,9 @@ InternedString* InternedStringMap::get(const string& s)
     }
 
     Stack<InternedString*> interned;
-    interned = static_cast<InternedString*>(gc.create<String>(s));
+    interned = static_cast<InternedString*>(String::create(s.data(), s.size()));
     assert(interned->type());
+    interned->hash();
     strings_[s] = interned;
     assert(strings_.find(s) != strings_.end());
     return interned;
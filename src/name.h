@@ -45,10 +45,12 @@ using namespace std;
     _(slice)                                                                  \
     _(iter)                                                                   \
     _(SequenceIterator)                                                       \
+    _(stopIteration)                                                          \
     _(iterableToList)                                                         \
     _(inUsingIteration)                                                       \
     _(inUsingSubscript)                                                       \
     _(__import__)                                                             \
+    _(sorted)                                                                 \
     _(locals)                                                                 \
     _(globals)                                                                \
     _(__path__)                                                               \
@@ -61,7 +63,11 @@ using namespace std;
     _(loadModule)                                                             \
     _(__package__)                                                            \
     _(__main__)                                                               \
-    _(builtins)
+    _(builtins)                                                               \
+    _(True)                                                                   \
+    _(False)                                                                  \
+    _(None)                                                                   \
+    _(range)
 
 struct InternedString;
 struct String;
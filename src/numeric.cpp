@@ -625,17 +625,6 @@ typedef double (FloatUnaryOp)(double);
 static double floatPos(double a) { return a; }
 static double floatNeg(double a) { return -a; }
 
-static double floatHash(double a)
-{
-    union PunnedDouble {
-        double d;
-        uint64_t i;
-    };
-
-    PunnedDouble p = { a };
-    return p.i;
-}
-
 static bool floatValue(Traced<Value> value, double& out)
 {
     if (value.isFloat())
@@ -673,6 +662,18 @@ static bool floatUnaryOp(NativeArgs args, MutableTraced<Value> resultOut)
     return true;
 }
 
+static bool float_hash(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    double a;
+    if (!floatValue(args[0], a)) {
+        resultOut = NotImplemented;
+        return true;
+    }
+
+    resultOut = Integer::get(int64_t(HashFloat(a)));
+    return true;
+}
+
 template <BinaryOp Op>
 static bool
 floatBinaryOp(NativeArgs args, MutableTraced<Value> resultOut)
@@ -780,7 +781,7 @@ void Float::init()
     Stack<Value> value;
     initNativeMethod(cls, "__pos__", floatUnaryOp<floatPos>, 1);
     initNativeMethod(cls, "__neg__", floatUnaryOp<floatNeg>, 1);
-    initNativeMethod(cls, "__hash__", floatUnaryOp<floatHash>, 1);
+    initNativeMethod(cls, "__hash__", float_hash, 1);
     initNativeMethod(cls, "__add__", floatBinaryOp<BinaryAdd>, 2);
     initNativeMethod(cls, "__sub__", floatBinaryOp<BinarySub>, 2);
     initNativeMethod(cls, "__mul__", floatBinaryOp<BinaryMul>, 2);
@@ -40,12 +40,30 @@ Object* Object::create()
     return gc.create<Object>(ObjectClass);
 }
 
+Object* Object::createWithInlineSlots(Traced<Class*> cls,
+                                      Traced<Layout*> layout,
+                                      size_t inlineSlots)
+{
+    size_t size = sizeof(Object) + inlineSlots * sizeof(Value);
+    return gc.createSized<Object>(size, cls, layout, inlineSlots);
+}
+
 Object::Object(Traced<Class*> cls, Traced<Layout*> layout)
   : layout_(layout)
 {
     init(cls, layout);
 }
 
+Object::Object(Traced<Class*> cls, Traced<Layout*> layout, size_t inlineSlots)
+  : layout_(layout)
+{
+    // The inline slots follow the object, so slots_ must be the last member.
+    assert(reinterpret_cast<uint8_t*>(&slots_ + 1) ==
+           reinterpret_cast<uint8_t*>(this) + sizeof(Object));
+    slots_.initInlineCapacity(inlineSlots);
+    init(cls, layout);
+}
+
 void Object::init(Traced<Class*> cls, Traced<Layout*> layout)
 {
     assert(layout_);
@@ -200,7 +218,7 @@ void Object::setAttr(Name name, Traced<Value> value)
 bool Object::maybeDelOwnAttr(Name name)
 {
     Layout* layout = layout_->findAncestor(name);
-    if (!layout)
+    if (!layout || !hasSlot(layout->slotIndex()))
         return false;
 
     if (layout == layout_) {
@@ -300,7 +318,10 @@ Class::Class(string name,
              bool final)
   : Object(ObjectClass, initialLayout),
     name_(name),
-    final_(final)
+    final_(final),
+    instanceLayout_(Object::InitialLayout),
+    instanceSlots_(0),
+    trackedInstances_(0)
 {
     // base is null for Object when we are initializing.
     assert(!Class::ObjectClass || base);
@@ -354,6 +375,39 @@ void Class::traceChildren(Tracer& t)
     Object::traceChildren(t);
     gc.trace(t, &bases_);
     gc.trace(t, &mro_);
+    gc.trace(t, &instanceLayout_);
+}
+
+Object* Class::createInstance()
+{
+    Stack<Class*> cls(this);
+    if (trackedInstances_ < SlackTrackingCount)
+        return gc.create<Object>(cls);
+
+    Stack<Layout*> layout(instanceLayout_);
+    size_t inlineSlots = instanceSlots_;
+    if (inlineSlots > MaxInlineInstanceSlots)
+        inlineSlots = MaxInlineInstanceSlots;
+    return Object::createWithInlineSlots(cls, layout, inlineSlots);
+}
+
+void Class::trackInstanceLayout(Traced<Object*> instance)
+{
+    if (trackedInstances_ == SlackTrackingCount)
+        return;
+
+    Stack<Layout*> layout(instance->layout());
+    Stack<Layout*> predicted(instanceLayout_);
+    instanceSlots_ = max(instanceSlots_, layout->slotCount());
+    trackedInstances_++;
+    if (layout->subsumes(predicted)) {
+        instanceLayout_ = layout;
+    } else if (!predicted->subsumes(layout)) {
+        // Instances have different layouts so stop tracking and only
+        // preallocate their slots.
+        instanceLayout_ = Object::InitialLayout;
+        trackedInstances_ = SlackTrackingCount;
+    }
 }
 
 void Class::print(ostream& s) const
@@ -440,9 +494,9 @@ static bool object_dump(NativeArgs args, MutableTraced<Value> resultOut)
     return true;
 }
 
-static bool object_hash(NativeArgs args, MutableTraced<Value> resultOut)
+bool object_hash(NativeArgs args, MutableTraced<Value> resultOut)
 {
-    resultOut = Integer::get((int32_t)(uintptr_t)args[0].toObject());
+    resultOut = Integer::get(int64_t(HashIdentity(args[0].toObject())));
     return true;
 }
 
@@ -584,7 +638,7 @@ static bool getSpecialAttr(Traced<Value> value, Name name,
     if (value.is<Class>()) {
         Stack<Class*> cls(value.asObject()->as<Class>());
         if (name == Names::__name__) {
-            resultOut = gc.create<String>(cls->name());
+            resultOut = String::get(cls->name());
             return true;
         }
         if (name == Names::__bases__) {
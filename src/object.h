@@ -31,6 +31,12 @@ struct Object : public Cell
 
     static Object* create();
 
+    // Create an object with storage for |inlineSlots| slots allocated as part
+    // of the object itself.
+    static Object* createWithInlineSlots(Traced<Class*> cls,
+                                         Traced<Layout*> layout,
+                                         size_t inlineSlots);
+
     Object(Traced<Class*> cls, Traced<Layout*> layout = InitialLayout);
 
     virtual ~Object() {}
@@ -113,6 +119,9 @@ struct Object : public Cell
     Heap<Layout*> layout_;
     HeapVector<Value, InlineVectorBase<Value>> slots_;
 
+    friend struct GC;
+    Object(Traced<Class*> cls, Traced<Layout*> layout, size_t inlineSlots);
+
     void init(Traced<Class*> cls, Traced<Layout*> layout);
 
     virtual void dumpInternals(ostream& s) const {}
@@ -164,6 +173,13 @@ struct Class : public Object
 
     bool maybeGetClassAttr(Name name, MutableTraced<Value> valueOut) const;
 
+    // Create an instance for object.__new__, using the layout of previous
+    // instances to size it.
+    Object* createInstance();
+
+    // Record the layout of an instance after its constructor has run.
+    void trackInstanceLayout(Traced<Object*> instance);
+
     void traceChildren(Tracer& t) override;
 
     void print(ostream& s) const override;
@@ -174,6 +190,14 @@ struct Class : public Object
     mutable Heap<Tuple*> mro_;
     bool final_;
 
+    // Slack tracking: the layouts of the first few instances are recorded and
+    // used to preallocate subsequent instances.
+    static const unsigned SlackTrackingCount = 8;
+    static const size_t MaxInlineInstanceSlots = 16;
+    Heap<Layout*> instanceLayout_;
+    unsigned instanceSlots_;
+    unsigned trackedInstances_;
+
     // Only for use during initialization
     void finishInit(Traced<Class*> base);
     void finishInitNoBases();
@@ -187,6 +211,7 @@ struct Class : public Object
 };
 
 extern bool object_new(NativeArgs args, MutableTraced<Value> resultOut);
+extern bool object_hash(NativeArgs args, MutableTraced<Value> resultOut);
 
 extern void initAttr(Traced<Object*> cls, const string& name,
                      Traced<Value> value);
@@ -0,0 +1,304 @@
+#include "range.h"
+
+#include "exception.h"
+#include "numeric.h"
+#include "singletons.h"
+
+#include "value-inl.h"
+
+#include <cmath>
+
+GlobalRoot<Class*> Range::ObjectClass;
+GlobalRoot<Class*> RangeIter::ObjectClass;
+
+/* static */ bool Range::getArgs(NativeArgs args, int32_t& startOut,
+                                 int32_t& stopOut, int32_t& stepOut)
+{
+    if (args.size() < 1 || args.size() > 3)
+        return false;
+
+    int32_t values[3];
+    for (size_t i = 0; i < args.size(); i++) {
+        if (!args[i].isInt() || !args[i].toInt32(values[i]))
+            return false;
+    }
+
+    startOut = args.size() == 1 ? 0 : values[0];
+    stopOut = args.size() == 1 ? values[0] : values[1];
+    stepOut = args.size() == 3 ? values[2] : 1;
+    return stepOut != 0;
+}
+
+Range::Range(Traced<Value> start, Traced<Value> stop, Traced<Value> step)
+  : Object(ObjectClass), start_(start), stop_(stop), step_(step)
+{
+    assert(start.isInt() && stop.isInt() && step.isInt());
+    assert(step.get() != Value(0));
+}
+
+void Range::traceChildren(Tracer& t)
+{
+    Object::traceChildren(t);
+    gc.trace(t, &start_);
+    gc.trace(t, &stop_);
+    gc.trace(t, &step_);
+}
+
+static mpz_class ToMpz(Value value)
+{
+    if (value.isInt32())
+        return mpz_class(value.asInt32());
+    return value.as<Integer>()->value();
+}
+
+static mpz_class BigLength(const mpz_class& start, const mpz_class& stop,
+                           const mpz_class& step)
+{
+    if (step > 0)
+        return stop > start ? mpz_class((stop - start + step - 1) / step) : 0;
+    return stop < start ? mpz_class((start - stop - step - 1) / -step) : 0;
+}
+
+int64_t Range::len32() const
+{
+    // Calculate in 64 bits to avoid overflow for large ranges.
+    assert(isInt32());
+    int64_t start = start_.get().asInt32();
+    int64_t stop = stop_.get().asInt32();
+    int64_t step = step_.get().asInt32();
+    if (step > 0)
+        return stop > start ? (stop - start + step - 1) / step : 0;
+    return stop < start ? (start - stop - step - 1) / -step : 0;
+}
+
+Value Range::len() const
+{
+    if (isInt32())
+        return Integer::get(len32());
+
+    AutoSupressGC supressGC;
+    return Integer::get(BigLength(ToMpz(start_), ToMpz(stop_), ToMpz(step_)));
+}
+
+bool Range::getitem(Traced<Value> index, MutableTraced<Value> resultOut) const
+{
+    assert(index.isInt());
+    int32_t i;
+    if (isInt32() && index.toInt32(i)) {
+        int64_t len = len32();
+        int64_t pos = i >= 0 ? i : len + i;
+        if (pos < 0 || pos >= len)
+            return Raise<IndexError>("range object index out of range",
+                                     resultOut);
+        resultOut = Value(getitem32(pos));
+        return true;
+    }
+
+    AutoSupressGC supressGC;
+    mpz_class start = ToMpz(start_);
+    mpz_class step = ToMpz(step_);
+    mpz_class len = BigLength(start, ToMpz(stop_), step);
+    mpz_class pos = ToMpz(index);
+    if (pos < 0)
+        pos += len;
+    if (pos < 0 || pos >= len)
+        return Raise<IndexError>("range object index out of range", resultOut);
+
+    resultOut = Integer::get(mpz_class(start + pos * step));
+    return true;
+}
+
+template <typename T>
+static bool RangeContains(const T& start, const T& stop, const T& step,
+                          const T& value)
+{
+    if (step > 0 ? value < start || value >= stop
+                 : value > start || value <= stop)
+    {
+        return false;
+    }
+
+    return (value - start) % step == 0;
+}
+
+bool Range::contains(Traced<Value> value) const
+{
+    if (isInt32() && value.isInt32()) {
+        return RangeContains<int64_t>(start_.get().asInt32(),
+                                      stop_.get().asInt32(),
+                                      step_.get().asInt32(),
+                                      value.asInt32());
+    }
+
+    AutoSupressGC supressGC;
+    mpz_class i;
+    if (value.isInt()) {
+        i = ToMpz(value);
+    } else if (value.isFloat()) {
+        // A float is equal to an element if it has the same integral value.
+        double d = value.toFloat();
+        if (!std::isfinite(d) || d != std::trunc(d))
+            return false;
+        i = d;
+    } else {
+        return false;
+    }
+
+    return RangeContains<mpz_class>(ToMpz(start_), ToMpz(stop_), ToMpz(step_),
+                                    i);
+}
+
+void Range::print(ostream& s) const
+{
+    s << "range(" << start_.get() << ", " << stop_.get();
+    if (step_.get() != Value(1))
+        s << ", " << step_.get();
+    s << ")";
+}
+
+RangeIter::RangeIter(Traced<Range*> range)
+  : Object(ObjectClass),
+    current_(range->start()),
+    stop_(range->stop()),
+    step_(range->step())
+{}
+
+void RangeIter::traceChildren(Tracer& t)
+{
+    Object::traceChildren(t);
+    gc.trace(t, &current_);
+    gc.trace(t, &stop_);
+    gc.trace(t, &step_);
+}
+
+bool RangeIter::next(MutableTraced<Value> resultOut)
+{
+    Value current = current_;
+    Value stop = stop_;
+    Value step = step_;
+    if (current.isInt32() && stop.isInt32() && step.isInt32()) {
+        int32_t i = current.asInt32();
+        int32_t value;
+        if (!Range::next(i, stop.asInt32(), step.asInt32(), value)) {
+            current_ = stop;
+            resultOut = StopIterationException;
+            return false;
+        }
+
+        current_ = Value(i);
+        resultOut = Value(value);
+        return true;
+    }
+
+    AutoSupressGC supressGC;
+    mpz_class i = ToMpz(current);
+    mpz_class end = ToMpz(stop);
+    mpz_class delta = ToMpz(step);
+    if (delta > 0 ? i >= end : i <= end) {
+        current_ = stop;
+        resultOut = StopIterationException;
+        return false;
+    }
+
+    resultOut = current;
+    current_ = Integer::get(mpz_class(i + delta));
+    return true;
+}
+
+static bool range_new(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], Class::ObjectClass, resultOut))
+        return false;
+
+    if (args.size() < 2)
+        return Raise<TypeError>("range expected 1 argument, got 0", resultOut);
+
+    // Normalise the bounds so that bools are stored as plain ints.
+    RootVector<Value> bounds(args.size() - 1);
+    for (size_t i = 0; i < bounds.size(); i++) {
+        Stack<Value> arg(args[i + 1]);
+        if (!arg.isInt()) {
+            return Raise<TypeError>(
+                "range() arguments must be integers", resultOut);
+        }
+        if (arg.isInt32()) {
+            bounds[i] = arg;
+        } else {
+            AutoSupressGC supressGC;
+            bounds[i] = Integer::get(ToMpz(arg));
+        }
+    }
+
+    Stack<Value> start(bounds.size() == 1 ? Value(0) : bounds[0]);
+    Stack<Value> stop(bounds.size() == 1 ? bounds[0] : bounds[1]);
+    Stack<Value> step(bounds.size() == 3 ? bounds[2] : Value(1));
+    if (step == Value(0))
+        return Raise<ValueError>("range() arg 3 must not be zero", resultOut);
+
+    resultOut = gc.create<Range>(start, stop, step);
+    return true;
+}
+
+static bool range_len(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    resultOut = args[0].as<Range>()->len();
+    return true;
+}
+
+static bool range_getitem(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Range*> self(args[0].as<Range>());
+    Stack<Value> index(args[1]);
+    if (!index.isInt())
+        return Raise<TypeError>("range indices must be integers", resultOut);
+
+    return self->getitem(index, resultOut);
+}
+
+static bool range_contains(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Range*> self(args[0].as<Range>());
+    Stack<Value> value(args[1]);
+    resultOut = Boolean::get(self->contains(value));
+    return true;
+}
+
+static bool range_iter(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Range*> self(args[0].as<Range>());
+    resultOut = gc.create<RangeIter>(self);
+    return true;
+}
+
+static bool rangeIter_iter(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    resultOut = args[0];
+    return true;
+}
+
+static bool rangeIter_next(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    return args[0].as<RangeIter>()->next(resultOut);
+}
+
+void Range::init()
+{
+    ObjectClass.init(Class::createNative("range", range_new, 4));
+    initNativeMethod(ObjectClass, "__len__", range_len, 1);
+    initNativeMethod(ObjectClass, "__getitem__", range_getitem, 2);
+    initNativeMethod(ObjectClass, "__contains__", range_contains, 2);
+    initNativeMethod(ObjectClass, "__iter__", range_iter, 1);
+}
+
+void RangeIter::init()
+{
+    ObjectClass.init(Class::createNative("rangeiterator", nullptr));
+    initNativeMethod(ObjectClass, "__iter__", rangeIter_iter, 1);
+    initNativeMethod(ObjectClass, "__next__", rangeIter_next, 1);
+}
+
+void initRange()
+{
+    Range::init();
+    RangeIter::init();
+}
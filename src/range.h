@@ -0,0 +1,87 @@
+#ifndef __RANGE_H__
+#define __RANGE_H__
+
+#include "object.h"
+
+// An immutable sequence of integers, as returned by range().
+//
+// The bounds can be arbitrary integers, but ranges whose bounds all fit in 32
+// bits take fast paths for length, indexing, membership and iteration.
+struct Range : public Object
+{
+    static void init();
+
+    static GlobalRoot<Class*> ObjectClass;
+
+    // Extract start, stop and step from range() arguments, returning false
+    // if they are not all valid 32 bit integers.
+    static bool getArgs(NativeArgs args,
+                        int32_t& startOut, int32_t& stopOut, int32_t& stepOut);
+
+    // Advance a counting loop over a range, returning false when finished.
+    static bool next(int32_t& current, int32_t stop, int32_t step,
+                     int32_t& valueOut) {
+        if (step > 0 ? current >= stop : current <= stop)
+            return false;
+
+        valueOut = current;
+        int64_t following = int64_t(current) + step;
+        current = int32_t(following) == following ? following : stop;
+        return true;
+    }
+
+    Range(Traced<Value> start, Traced<Value> stop, Traced<Value> step);
+
+    void traceChildren(Tracer& t) override;
+
+    Value start() const { return start_; }
+    Value stop() const { return stop_; }
+    Value step() const { return step_; }
+
+    bool isInt32() const {
+        return start_.get().isInt32() && stop_.get().isInt32() &&
+               step_.get().isInt32();
+    }
+
+    // The length of a range with 32 bit bounds, which can exceed INT32_MAX.
+    int64_t len32() const;
+    int32_t getitem32(int64_t index) const {
+        assert(isInt32());
+        assert(index >= 0 && index < len32());
+        return start_.get().asInt32() + index * step_.get().asInt32();
+    }
+
+    // These work for any bounds and can GC.
+    Value len() const;
+    bool getitem(Traced<Value> index, MutableTraced<Value> resultOut) const;
+    bool contains(Traced<Value> value) const;
+
+    void print(ostream& s) const override;
+
+  private:
+    Heap<Value> start_;
+    Heap<Value> stop_;
+    Heap<Value> step_;
+};
+
+struct RangeIter : public Object
+{
+    static void init();
+
+    static GlobalRoot<Class*> ObjectClass;
+
+    RangeIter(Traced<Range*> range);
+
+    void traceChildren(Tracer& t) override;
+
+    bool next(MutableTraced<Value> resultOut);
+
+  private:
+    Heap<Value> current_;
+    Heap<Value> stop_;
+    Heap<Value> step_;
+};
+
+extern void initRange();
+
+#endif
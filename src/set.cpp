@@ -1,12 +1,15 @@
 #include "set.h"
 
+#include "builtin.h"
 #include "callable.h"
 #include "exception.h"
 #include "interp.h"
 #include "list.h"
 #include "numeric.h"
 #include "repr.h"
+#include "singletons.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 GlobalRoot<Class*> Set::ObjectClass;
@@ -32,6 +35,7 @@ static bool set_add(NativeArgs args, MutableTraced<Value> resultOut)
 {
     Stack<T*> set(args[0].as<T>());;
     set->add(args[1]);
+    resultOut = None;
     return true;
 }
 
@@ -43,20 +47,242 @@ static bool set_keys(NativeArgs args, MutableTraced<Value> resultOut)
     return true;
 }
 
+template <typename T>
+static bool set_iter(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<T*> set(args[0].as<T>());
+    resultOut = gc.create<KeyIterImpl<T>>(set);
+    return true;
+}
+
+template <typename T>
+static bool set_discard(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<T*> set(args[0].as<T>());
+    set->remove(args[1]);
+    resultOut = None;
+    return true;
+}
+
+template <typename T>
+static bool set_remove(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<T*> set(args[0].as<T>());
+    Stack<Value> element(args[1]);
+    if (!set->remove(element))
+        return Raise<KeyError>(repr(element.get()), resultOut);
+    resultOut = None;
+    return true;
+}
+
+// Get a set containing the elements of an iterable, which may be the argument
+// itself if it is already a set.
+static bool SetFromIterable(Traced<Value> arg, MutableTraced<Value> resultOut)
+{
+    if (arg.isInstanceOf(Set::ObjectClass)) {
+        resultOut = arg;
+        return true;
+    }
+
+    Stack<Value> list(arg);
+    if (!arg.isInstanceOf(List::ObjectClass) &&
+        !arg.isInstanceOf(Tuple::ObjectClass))
+    {
+        if (!interp->call(IterableToList, arg, list)) {
+            resultOut = list;
+            return false;
+        }
+    }
+
+    Stack<Set*> set(gc.create<Set>());
+    Stack<Value> element;
+    if (list.isInstanceOf(Tuple::ObjectClass)) {
+        Stack<Tuple*> tuple(list.as<Tuple>());
+        for (int32_t i = 0; i < tuple->len(); i++) {
+            element = tuple->getitem(i);
+            set->add(element);
+        }
+    } else {
+        Stack<List*> elements(list.as<List>());
+        for (int32_t i = 0; i < elements->len(); i++) {
+            element = elements->getitem(i);
+            set->add(element);
+        }
+    }
+    resultOut = Value(set);
+    return true;
+}
+
+static bool set_new(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], Class::ObjectClass, resultOut))
+        return false;
+
+    Stack<Class*> cls(args[0].asObject()->as<Class>());
+    Stack<Set*> set(gc.create<Set>(cls));
+    if (args.size() == 2) {
+        Stack<Value> other;
+        if (!SetFromIterable(args[1], other)) {
+            resultOut = other;
+            return false;
+        }
+        Stack<Set*> elements(other.as<Set>());
+        set->update(elements);
+    }
+    resultOut = Value(set);
+    return true;
+}
+
+typedef Set* (*SetOp)(Traced<Set*> a, Traced<Set*> b);
+
+// Binary operators only accept sets.
+template <SetOp op>
+static bool set_binaryOp(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!args[1].isInstanceOf(Set::ObjectClass)) {
+        resultOut = NotImplemented;
+        return true;
+    }
+
+    Stack<Set*> a(args[0].as<Set>());
+    Stack<Set*> b(args[1].as<Set>());
+    resultOut = op(a, b);
+    return true;
+}
+
+// Named methods accept any iterable.
+template <SetOp op>
+static bool set_method(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Value> other;
+    if (!SetFromIterable(args[1], other)) {
+        resultOut = other;
+        return false;
+    }
+
+    Stack<Set*> a(args[0].as<Set>());
+    Stack<Set*> b(other.as<Set>());
+    resultOut = op(a, b);
+    return true;
+}
+
+typedef void (Set::*SetUpdateOp)(Traced<Set*> other);
+
+template <SetUpdateOp op>
+static bool set_inPlaceOp(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!args[1].isInstanceOf(Set::ObjectClass)) {
+        resultOut = NotImplemented;
+        return true;
+    }
+
+    Stack<Set*> a(args[0].as<Set>());
+    Stack<Set*> b(args[1].as<Set>());
+    (a->*op)(b);
+    resultOut = Value(a);
+    return true;
+}
+
+template <SetUpdateOp op>
+static bool set_updateMethod(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Value> other;
+    if (!SetFromIterable(args[1], other)) {
+        resultOut = other;
+        return false;
+    }
+
+    Stack<Set*> a(args[0].as<Set>());
+    Stack<Set*> b(other.as<Set>());
+    (a->*op)(b);
+    resultOut = None;
+    return true;
+}
+
+template <bool superset>
+static bool set_isSubset(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    Stack<Value> other;
+    if (!SetFromIterable(args[1], other)) {
+        resultOut = other;
+        return false;
+    }
+
+    Stack<Set*> a(args[0].as<Set>());
+    Stack<Set*> b(other.as<Set>());
+    resultOut = Boolean::get(superset ? b->isSubsetOf(a) : a->isSubsetOf(b));
+    return true;
+}
+
+template <bool superset>
+static bool set_compareSubset(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!args[1].isInstanceOf(Set::ObjectClass)) {
+        resultOut = NotImplemented;
+        return true;
+    }
+
+    Stack<Set*> a(args[0].as<Set>());
+    Stack<Set*> b(args[1].as<Set>());
+    resultOut = Boolean::get(superset ? b->isSubsetOf(a) : a->isSubsetOf(b));
+    return true;
+}
+
+template <bool equal>
+static bool set_eq(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!args[1].isInstanceOf(Set::ObjectClass)) {
+        resultOut = Boolean::get(!equal);
+        return true;
+    }
+
+    Stack<Set*> a(args[0].as<Set>());
+    Stack<Set*> b(args[1].as<Set>());
+    resultOut = Boolean::get(a->equals(b) == equal);
+    return true;
+}
+
 template <typename T>
 static void SetInit(const char* name)
 {
-    T::ObjectClass.init(Class::createNative<T>(name));
+    T::ObjectClass.init(Class::createNative(name, set_new, 2));
     initNativeMethod(T::ObjectClass, "__len__", set_len<T>, 1);
     initNativeMethod(T::ObjectClass, "__contains__", set_contains<T>, 2);
     initNativeMethod(T::ObjectClass, "add", set_add<T>, 2);
+    initNativeMethod(T::ObjectClass, "discard", set_discard<T>, 2);
+    initNativeMethod(T::ObjectClass, "remove", set_remove<T>, 2);
     initNativeMethod(T::ObjectClass, "keys", set_keys<T>, 1);
-    // __eq__ and __ne__ are supplied by internals/internal.py
+    initNativeMethod(T::ObjectClass, "__iter__", set_iter<T>, 1);
 }
 
 void Set::init()
 {
     SetInit<Set>("set");
+    SetIter::init("set_iterator");
+
+    Stack<Class*> cls(ObjectClass);
+    initNativeMethod(cls, "__eq__", set_eq<true>, 2);
+    initNativeMethod(cls, "__ne__", set_eq<false>, 2);
+    initNativeMethod(cls, "__or__", set_binaryOp<getUnion>, 2);
+    initNativeMethod(cls, "__and__", set_binaryOp<getIntersection>, 2);
+    initNativeMethod(cls, "__sub__", set_binaryOp<getDifference>, 2);
+    initNativeMethod(cls, "__le__", set_compareSubset<false>, 2);
+    initNativeMethod(cls, "__ge__", set_compareSubset<true>, 2);
+    initNativeMethod(cls, "__ior__", set_inPlaceOp<&Set::update>, 2);
+    initNativeMethod(cls, "__iand__",
+                     set_inPlaceOp<&Set::intersectionUpdate>, 2);
+    initNativeMethod(cls, "__isub__", set_inPlaceOp<&Set::differenceUpdate>,
+                     2);
+    initNativeMethod(cls, "union", set_method<getUnion>, 2);
+    initNativeMethod(cls, "intersection", set_method<getIntersection>, 2);
+    initNativeMethod(cls, "difference", set_method<getDifference>, 2);
+    initNativeMethod(cls, "issubset", set_isSubset<false>, 2);
+    initNativeMethod(cls, "issuperset", set_isSubset<true>, 2);
+    initNativeMethod(cls, "update", set_updateMethod<&Set::update>, 2);
+    initNativeMethod(cls, "intersection_update",
+                     set_updateMethod<&Set::intersectionUpdate>, 2);
+    initNativeMethod(cls, "difference_update",
+                     set_updateMethod<&Set::differenceUpdate>, 2);
 }
 
 Set::Set()
@@ -64,10 +290,11 @@ Set::Set()
 {}
 
 Set::Set(const TracedVector<Value>& values)
-  : Object(ObjectClass), elements_(values.size() / 2)
+  : Object(ObjectClass)
 {
+    table_ = SetTable::get(values.size());
     for (unsigned i = 0; i < values.size(); ++i)
-        elements_.insert(values[i]);
+        add(values[i]);
 }
 
 Set::Set(Traced<Class*> cls)
@@ -79,44 +306,225 @@ Set::Set(Traced<Class*> cls)
 void Set::traceChildren(Tracer& t)
 {
     Object::traceChildren(t);
-    for (auto i = elements_.begin(); i != elements_.end(); ++i) {
-        Value key = *i;
-#ifdef DEBUG
-        Value prior = key;
-#endif
-        gc.traceUnbarriered(t, &key);
-        assert(key == prior);
-    }
+    gc.trace(t, &table_);
 }
 
 void Set::print(ostream& s) const
 {
     s << "{";
-    for (auto i = elements_.begin(); i != elements_.end(); ++i) {
-        if (i != elements_.begin())
+    bool first = true;
+    for (const auto& i : SetTable::Entries(table_)) {
+        if (!first)
             s << ", ";
-        s << *i;
+        s << i.key.get();
+        first = false;
     }
     s << "}";
 }
 
-void Set::add(Traced<Value> element)
+bool Set::contains(Traced<Value> elementArg) const
+{
+    // Hashing and comparing elements can run code that reallocates the
+    // interpreter stack, which may be where the arguments live.
+    Stack<Value> element(elementArg);
+    return contains(element, ValueHash()(element));
+}
+
+bool Set::contains(Traced<Value> element, size_t hash) const
 {
-    elements_.insert(element);
+    return SetTable::find(table_, element, hash) != SetTable::NotFound;
+}
+
+void Set::add(Traced<Value> elementArg)
+{
+    Stack<Value> element(elementArg);
+    add(element, ValueHash()(element));
+}
+
+void Set::add(Traced<Value> element, size_t hash)
+{
+    if (contains(element, hash))
+        return;
+
+    if (!table_ || table_->isFull())
+        grow();
+    table_->append(hash, element);
+}
+
+void Set::grow()
+{
+    // Rebuild the table using the stored hashes, dropping deleted entries.
+    size_t count = len();
+    size_t capacity = max(count * 2, count + 1);
+    table_ = table_ ? table_->rebuild(capacity) : SetTable::get(capacity);
+}
+
+bool Set::remove(Traced<Value> elementArg)
+{
+    Stack<Value> element(elementArg);
+    return remove(element, ValueHash()(element));
+}
+
+bool Set::remove(Traced<Value> element, size_t hash)
+{
+    int32_t e = SetTable::find(table_, element, hash);
+    if (e == SetTable::NotFound)
+        return false;
+
+    table_->remove(e);
+    return true;
 }
 
 void Set::clear()
 {
-    elements_.clear();
+    table_ = nullptr;
 }
 
 Value Set::keys() const
 {
     // todo: should be some kind of iterator?
-    Stack<Tuple*> keys(Tuple::getUninitialised(elements_.size()));
+    Stack<Tuple*> keys(Tuple::getUninitialised(len()));
     size_t index = 0;
-    for (const auto& i : elements_)
-        keys->initElement(index++, i);
+    for (const auto& i : SetTable::Entries(table_))
+        keys->initElement(index++, i.key);
     return Value(keys);
 }
 
+template <typename F>
+void Set::forEach(F&& f) const
+{
+    // Iterate by position over a rooted table as comparing elements may run
+    // code that modifies this set.
+    Stack<SetTable*> table(table_);
+    if (!table)
+        return;
+
+    Stack<Value> element;
+    for (size_t i = 0; i < table->used(); i++) {
+        const SetEntry& entry = table->entry(i);
+        if (entry.isDeleted())
+            continue;
+
+        element = entry.key;
+        if (!f(element, entry.hash))
+            return;
+    }
+}
+
+/* static */ Set* Set::copy(Traced<Set*> set, size_t minCapacity)
+{
+    Stack<Set*> result(gc.create<Set>());
+    if (set->table_) {
+        size_t capacity = max(set->len(), minCapacity);
+        result->table_ = set->table_->rebuild(capacity);
+    }
+    return result;
+}
+
+/* static */ Set* Set::getUnion(Traced<Set*> a, Traced<Set*> b)
+{
+    bool aIsLarger = a->len() >= b->len();
+    Stack<Set*> larger(aIsLarger ? a : b);
+    Stack<Set*> smaller(aIsLarger ? b : a);
+    Stack<Set*> result(copy(larger, larger->len() + smaller->len()));
+    smaller->forEach([&] (Traced<Value> element, size_t hash) {
+        result->add(element, hash);
+        return true;
+    });
+    return result;
+}
+
+/* static */ Set* Set::getIntersection(Traced<Set*> a, Traced<Set*> b)
+{
+    bool aIsLarger = a->len() >= b->len();
+    Stack<Set*> larger(aIsLarger ? a : b);
+    Stack<Set*> smaller(aIsLarger ? b : a);
+    Stack<Set*> result(gc.create<Set>());
+    smaller->forEach([&] (Traced<Value> element, size_t hash) {
+        if (larger->contains(element, hash))
+            result->add(element, hash);
+        return true;
+    });
+    return result;
+}
+
+/* static */ Set* Set::getDifference(Traced<Set*> a, Traced<Set*> b)
+{
+    if (a->len() <= b->len()) {
+        Stack<Set*> result(gc.create<Set>());
+        a->forEach([&] (Traced<Value> element, size_t hash) {
+            if (!b->contains(element, hash))
+                result->add(element, hash);
+            return true;
+        });
+        return result;
+    }
+
+    Stack<Set*> result(copy(a));
+    result->differenceUpdate(b);
+    return result;
+}
+
+bool Set::isSubsetOf(Traced<Set*> other) const
+{
+    if (len() > other->len())
+        return false;
+
+    bool result = true;
+    forEach([&] (Traced<Value> element, size_t hash) {
+        result = other->contains(element, hash);
+        return result;
+    });
+    return result;
+}
+
+bool Set::equals(Traced<Set*> other) const
+{
+    return len() == other->len() && isSubsetOf(other);
+}
+
+void Set::update(Traced<Set*> other)
+{
+    other->forEach([&] (Traced<Value> element, size_t hash) {
+        add(element, hash);
+        return true;
+    });
+}
+
+void Set::intersectionUpdate(Traced<Set*> other)
+{
+    if (len() <= other->len()) {
+        forEach([&] (Traced<Value> element, size_t hash) {
+            if (!other->contains(element, hash))
+                remove(element, hash);
+            return true;
+        });
+        return;
+    }
+
+    Stack<Set*> self(this);
+    Stack<Set*> result(getIntersection(self, other));
+    table_ = result->table_;
+}
+
+void Set::differenceUpdate(Traced<Set*> other)
+{
+    if (other == this) {
+        clear();
+        return;
+    }
+
+    if (other->len() <= len()) {
+        other->forEach([&] (Traced<Value> element, size_t hash) {
+            remove(element, hash);
+            return true;
+        });
+        return;
+    }
+
+    forEach([&] (Traced<Value> element, size_t hash) {
+        if (other->contains(element, hash))
+            remove(element, hash);
+        return true;
+    });
+}
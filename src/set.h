@@ -1,12 +1,13 @@
 #ifndef __SET_H__
 #define __SET_H__
 
+#include "hashtable.h"
 #include "object.h"
 
-#include <unordered_set>
-
 struct Set : public Object
 {
+    using SetTable = HashTable<SetEntry>;
+
     static void init();
 
     static GlobalRoot<Class*> ObjectClass;
@@ -19,21 +20,45 @@ struct Set : public Object
     void print(ostream& s) const override;
 
     size_t len() const {
-        return elements_.size();
+        return table_ ? table_->count() : 0;
     }
 
-    bool contains(Traced<Value> element) const {
-        return elements_.find(element) != elements_.end();
-    }
+    bool contains(Traced<Value> element) const;
 
     Value keys() const;
 
     void add(Traced<Value> element);
+    bool remove(Traced<Value> element);
     void clear();
 
+    // Set algebra.  These iterate over the smaller of the two sets where
+    // possible and reuse the stored hashes rather than rehashing elements.
+    static Set* getUnion(Traced<Set*> a, Traced<Set*> b);
+    static Set* getIntersection(Traced<Set*> a, Traced<Set*> b);
+    static Set* getDifference(Traced<Set*> a, Traced<Set*> b);
+    static Set* copy(Traced<Set*> set, size_t minCapacity = 0);
+    bool isSubsetOf(Traced<Set*> other) const;
+    bool equals(Traced<Set*> other) const;
+    void update(Traced<Set*> other);
+    void intersectionUpdate(Traced<Set*> other);
+    void differenceUpdate(Traced<Set*> other);
+
+    SetTable* table() const { return table_; }
+
   private:
-    using SetImpl = unordered_set<Value, ValueHash, ValuesEqual>;
-    SetImpl elements_;
+    Heap<SetTable*> table_;
+
+    bool contains(Traced<Value> element, size_t hash) const;
+    void add(Traced<Value> element, size_t hash);
+    bool remove(Traced<Value> element, size_t hash);
+    void grow();
+
+    // Call f(element, hash) for each element until it returns false.
+    template <typename F>
+    void forEach(F&& f) const;
 };
 
+extern template struct KeyIterImpl<Set>;
+typedef KeyIterImpl<Set> SetIter;
+
 #endif
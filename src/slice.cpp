@@ -57,6 +57,20 @@ bool Slice::getSlotIfNotNone(unsigned slot, int32_t& resultOut)
     return true;
 }
 
+// Wrap a negative index and clamp the result to the range that can be
+// iterated in the direction given by step.
+static int32_t AdjustIndex(int32_t index, int32_t length, int32_t step)
+{
+    if (index < 0) {
+        index += length;
+        if (index < 0)
+            index = step < 0 ? -1 : 0;
+    } else if (index >= length) {
+        index = step < 0 ? length - 1 : length;
+    }
+    return index;
+}
+
 void Slice::indices(int32_t length, int32_t& start, int32_t& stop, int32_t& step)
 {
     // todo: should be a python method
@@ -66,14 +80,14 @@ void Slice::indices(int32_t length, int32_t& start, int32_t& stop, int32_t& step
         return;
 
     if (getSlotIfNotNone(StartSlot, start))
-        start = ClampIndex(WrapIndex(start, length), length, true);
+        start = AdjustIndex(start, length, step);
     else if (step > 0)
         start = 0;
     else
         start = length - 1;
 
     if (getSlotIfNotNone(StopSlot, stop))
-        stop = ClampIndex(WrapIndex(stop, length), length, false);
+        stop = AdjustIndex(stop, length, step);
     else if (step > 0)
         stop = length;
     else
@@ -35,9 +35,4 @@ inline int32_t WrapIndex(int32_t index, int32_t length)
     return min(index >= 0 ? index : length + index, length);
 }
 
-inline int32_t ClampIndex(int32_t index, int32_t length, bool inclusive)
-{
-    return max(min(index, length - (inclusive ? 1 : 0)), 0);
-}
-
 #endif
@@ -0,0 +1,249 @@
+#ifndef __SORT_H__
+#define __SORT_H__
+
+#include "assert.h"
+
+#include <algorithm>
+#include <cstddef>
+
+// A stable, adaptive merge sort in the style of Timsort.
+//
+// The input is split into natural runs, reversing strictly descending ones.
+// Short runs are extended to a minimum length with binary insertion sort and
+// the runs are merged pairwise, keeping the lengths of pending runs balanced.
+// Before each merge, elements that are already in their final position are
+// skipped using binary search.  Unlike CPython's implementation this does not
+// switch to galloping mode inside a merge.
+//
+// less must be a strict weak ordering to get a sorted result, but an
+// inconsistent comparison function will not cause out of bounds accesses.
+//
+// Every element is always present in either data or buffer, which must have
+// space for at least length / 2 elements.
+template <typename T, typename Less>
+struct TimSorter
+{
+    TimSorter(T* data, size_t length, T* buffer, Less less)
+      : data_(data), length_(length), buffer_(buffer), less_(less),
+        stackSize_(0)
+    {}
+
+    void sort() {
+        if (length_ < 2)
+            return;
+
+        size_t minRun = minRunLength(length_);
+        size_t start = 0;
+        while (start != length_) {
+            size_t end = findRun(start);
+            if (end - start < minRun) {
+                size_t forcedEnd = std::min(length_, start + minRun);
+                insertionSort(start, forcedEnd, end);
+                end = forcedEnd;
+            }
+            pushRun(start, end - start);
+            mergeCollapse();
+            start = end;
+        }
+        mergeForceCollapse();
+        assert(stackSize_ == 1);
+    }
+
+  private:
+    // Enough for any input that fits in memory.
+    static const size_t MaxRuns = 85;
+
+    T* data_;
+    size_t length_;
+    T* buffer_;
+    Less less_;
+
+    size_t stackSize_;
+    size_t runStart_[MaxRuns];
+    size_t runLength_[MaxRuns];
+
+    static size_t minRunLength(size_t length) {
+        // Choose a minimum run length in the range 32 to 64 such that the
+        // number of runs is a power of two or slightly less.
+        size_t bit = 0;
+        while (length >= 64) {
+            bit |= length & 1;
+            length >>= 1;
+        }
+        return length + bit;
+    }
+
+    // Return the end of the run starting at start, making it ascending.
+    size_t findRun(size_t start) {
+        size_t end = start + 1;
+        if (end == length_)
+            return end;
+
+        if (less_(data_[end], data_[start])) {
+            do {
+                end++;
+            } while (end != length_ && less_(data_[end], data_[end - 1]));
+            std::reverse(data_ + start, data_ + end);
+        } else {
+            do {
+                end++;
+            } while (end != length_ && !less_(data_[end], data_[end - 1]));
+        }
+        return end;
+    }
+
+    // Sort elements from start to end, given that those before sorted are
+    // already in order.
+    void insertionSort(size_t start, size_t end, size_t sorted) {
+        for (size_t i = sorted; i < end; i++) {
+            size_t pos = upperBound(start, i, data_[i]);
+            if (pos == i)
+                continue;
+
+            T pivot = data_[i];
+            for (size_t j = i; j != pos; j--)
+                data_[j] = data_[j - 1];
+            data_[pos] = pivot;
+        }
+    }
+
+    // Return the first position in a sorted range where the element is
+    // greater than value.
+    size_t upperBound(size_t start, size_t end, const T& value) {
+        while (start < end) {
+            size_t mid = start + (end - start) / 2;
+            if (less_(value, data_[mid]))
+                end = mid;
+            else
+                start = mid + 1;
+        }
+        return start;
+    }
+
+    // Return the first position in a sorted range where the element is not
+    // less than value.
+    size_t lowerBound(size_t start, size_t end, const T& value) {
+        while (start < end) {
+            size_t mid = start + (end - start) / 2;
+            if (less_(data_[mid], value))
+                start = mid + 1;
+            else
+                end = mid;
+        }
+        return start;
+    }
+
+    void pushRun(size_t start, size_t length) {
+        assert(stackSize_ < MaxRuns);
+        runStart_[stackSize_] = start;
+        runLength_[stackSize_] = length;
+        stackSize_++;
+    }
+
+    // Merge runs until the lengths of the last three on the stack satisfy
+    // A > B + C and B > C.
+    void mergeCollapse() {
+        size_t* len = runLength_;
+        while (stackSize_ > 1) {
+            size_t n = stackSize_ - 2;
+            if ((n > 0 && len[n - 1] <= len[n] + len[n + 1]) ||
+                (n > 1 && len[n - 2] <= len[n - 1] + len[n]))
+            {
+                if (len[n - 1] < len[n + 1])
+                    n--;
+            } else if (len[n] > len[n + 1]) {
+                break;
+            }
+            mergeAt(n);
+        }
+    }
+
+    void mergeForceCollapse() {
+        while (stackSize_ > 1) {
+            size_t n = stackSize_ - 2;
+            if (n > 0 && runLength_[n - 1] < runLength_[n + 1])
+                n--;
+            mergeAt(n);
+        }
+    }
+
+    // Merge the runs at positions i and i + 1 on the stack.
+    void mergeAt(size_t i) {
+        assert(i + 1 < stackSize_);
+        size_t startA = runStart_[i];
+        size_t lengthA = runLength_[i];
+        size_t startB = runStart_[i + 1];
+        size_t lengthB = runLength_[i + 1];
+        assert(startA + lengthA == startB);
+
+        runLength_[i] = lengthA + lengthB;
+        if (i + 3 == stackSize_) {
+            runStart_[i + 1] = runStart_[i + 2];
+            runLength_[i + 1] = runLength_[i + 2];
+        }
+        stackSize_--;
+
+        // Elements of A not greater than the first element of B and elements
+        // of B not less than the last element of A are already in place.
+        size_t skip = upperBound(startA, startB, data_[startB]) - startA;
+        startA += skip;
+        lengthA -= skip;
+        if (lengthA == 0)
+            return;
+
+        lengthB = lowerBound(startB, startB + lengthB, data_[startB - 1]) -
+                  startB;
+        if (lengthB == 0)
+            return;
+
+        if (lengthA <= lengthB)
+            mergeLow(startA, lengthA, startB, lengthB);
+        else
+            mergeHigh(startA, lengthA, startB, lengthB);
+    }
+
+    // Merge adjacent runs A and B where A is the shorter, working upwards.
+    void mergeLow(size_t startA, size_t lengthA,
+                  size_t startB, size_t lengthB) {
+        assert(lengthA <= length_ / 2);
+        std::copy(data_ + startA, data_ + startA + lengthA, buffer_);
+
+        size_t a = 0;
+        size_t b = startB;
+        size_t endB = startB + lengthB;
+        size_t dest = startA;
+        while (a != lengthA && b != endB) {
+            if (less_(data_[b], buffer_[a]))
+                data_[dest++] = data_[b++];
+            else
+                data_[dest++] = buffer_[a++];
+        }
+        std::copy(buffer_ + a, buffer_ + lengthA, data_ + dest);
+    }
+
+    // Merge adjacent runs A and B where B is the shorter, working downwards.
+    void mergeHigh(size_t startA, size_t lengthA,
+                   size_t startB, size_t lengthB) {
+        assert(lengthB <= length_ / 2);
+        std::copy(data_ + startB, data_ + startB + lengthB, buffer_);
+
+        size_t a = startA + lengthA;
+        size_t b = lengthB;
+        size_t dest = startB + lengthB;
+        while (a != startA && b != 0) {
+            if (less_(buffer_[b - 1], data_[a - 1]))
+                data_[--dest] = data_[--a];
+            else
+                data_[--dest] = buffer_[--b];
+        }
+        std::copy(buffer_, buffer_ + b, data_ + dest - b);
+    }
+};
+
+template <typename T, typename Less>
+inline void TimSort(T* data, size_t length, T* buffer, Less less)
+{
+    TimSorter<T, Less>(data, length, buffer, less).sort();
+}
+
+#endif
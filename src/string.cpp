@@ -1,5 +1,7 @@
 #include "string.h"
 
+#include "builtin.h"
+#include "bytesearch.h"
 #include "callable.h"
 #include "exception.h"
 #include "interp.h"
@@ -9,18 +11,18 @@
 
 #include "value-inl.h"
 
+#include <algorithm>
 #include <iostream>
 
-typedef bool (StringCompareOp)(const string&, const string&);
-static bool stringLT(const string& a, const string& b) { return a < b; }
-static bool stringLE(const string& a, const string& b) { return a <= b; }
-static bool stringGT(const string& a, const string& b) { return a > b; }
-static bool stringGE(const string& a, const string& b) { return a >= b; }
-static bool stringEQ(const string& a, const string& b) { return a == b; }
-static bool stringNE(const string& a, const string& b) { return a != b; }
+typedef bool (StringCompareOp)(int);
+static bool stringLT(int c) { return c < 0; }
+static bool stringLE(int c) { return c <= 0; }
+static bool stringGT(int c) { return c > 0; }
+static bool stringGE(int c) { return c >= 0; }
+static bool stringEQ(int c) { return c == 0; }
+static bool stringNE(int c) { return c != 0; }
 
-// todo: use this to replace str() function.
-static bool valueToString(Traced<Value> value, MutableTraced<Value> resultOut)
+bool valueToString(Traced<Value> value, MutableTraced<Value> resultOut)
 {
     if (value.is<String>()) {
         resultOut = value;
@@ -65,8 +67,9 @@ static bool str_add(NativeArgs args, MutableTraced<Value> resultOut) {
         return true;
     }
 
-    resultOut = String::get(args[0].as<String>()->value() +
-                            args[1].as<String>()->value());
+    Stack<String*> a(args[0].as<String>());
+    Stack<String*> b(args[1].as<String>());
+    resultOut = String::concat(a, b);
     return true;
 }
 
@@ -75,38 +78,23 @@ static bool str_str(NativeArgs args, MutableTraced<Value> resultOut) {
     return true;
 }
 
-static bool stringValue(Traced<Value> value, string& out)
-{
-    if (!value.is<String>())
-        return false;
-
-    out = value.as<const String>()->value();
-    return true;
-}
-
 template <StringCompareOp op>
 static bool stringCompareOp(NativeArgs args, MutableTraced<Value> resultOut)
 {
-    string a;
-    if (!stringValue(args[0], a)) {
-        resultOut = NotImplemented;
-        return true;
-    }
-
-    string b;
-    if (!stringValue(args[1], b)) {
+    if (!args[0].is<String>() || !args[1].is<String>()) {
         resultOut = NotImplemented;
         return true;
     }
 
-    resultOut = Boolean::get(op(a, b));
+    const String* a = args[0].as<String>();
+    const String* b = args[1].as<String>();
+    resultOut = Boolean::get(op(a->compare(b)));
     return true;
 }
 
 static bool str_len(NativeArgs args, MutableTraced<Value> resultOut)
 {
-    const string& s = args[0].as<String>()->value();
-    resultOut = Integer::get(s.size());
+    resultOut = Integer::get(args[0].as<String>()->size());
     return true;
 }
 
@@ -117,48 +105,357 @@ static bool str_getitem(NativeArgs args, MutableTraced<Value> resultOut)
 }
 
 static bool str_hash(NativeArgs args, MutableTraced<Value> resultOut) {
-    const string& a = args[0].as<String>()->value();
-    // todo: should probably use python hash algorithm for this.
-    resultOut = Integer::get(std::hash<string>()(a));
+    resultOut = Integer::get(int64_t(args[0].as<String>()->hash()));
     return true;
 }
 
 static bool str_contains(NativeArgs args, MutableTraced<Value> resultOut) {
-    const string& a = args[0].as<String>()->value();
-    const string& b = args[1].as<String>()->value();
-    resultOut = Boolean::get(a.find(b) != string::npos);
+    if (!args[1].is<String>()) {
+        return Raise<TypeError>("'in <string>' requires string as left operand",
+                                resultOut);
+    }
+
+    const String* a = args[0].as<String>();
+    const String* b = args[1].as<String>();
+    resultOut = Boolean::get(
+        FindBytes(a->data(), a->size(), b->data(), b->size()) != nullptr);
     return true;
 }
 
 static bool str_print(NativeArgs args, MutableTraced<Value> resultOut) {
-    const string& a = args[0].as<String>()->value();
-    cout << a << endl;
+    cout << args[0].as<String>()->value() << endl;
     resultOut = None;
     return true;
 }
 
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+           c == '\f';
+}
+
+// Get the range of a string to search from optional start and end arguments
+// at position first, following slice semantics.  The start may be greater
+// than the end, in which case there are no matches.
+static bool getSearchRange(NativeArgs args, size_t first, size_t length,
+                           size_t& startOut, size_t& endOut,
+                           MutableTraced<Value> resultOut)
+{
+    int32_t bounds[2] = { 0, int32_t(length) };
+    for (size_t i = 0; i < 2; i++) {
+        size_t arg = first + i;
+        if (arg >= args.size() || args[arg] == Value(None))
+            continue;
+
+        if (!args[arg].isInt() || !args[arg].toInt32(bounds[i])) {
+            return Raise<TypeError>("slice indices must be integers or None",
+                                    resultOut);
+        }
+
+        if (bounds[i] < 0)
+            bounds[i] = max(bounds[i] + int32_t(length), 0);
+    }
+
+    startOut = bounds[0];
+    endOut = min(size_t(bounds[1]), length);
+    return true;
+}
+
+// Find the position of the second argument in the first, or -1.
+static bool findSubstring(NativeArgs args, int64_t& posOut,
+                          MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], String::ObjectClass, resultOut) ||
+        !checkInstanceOf(args[1], String::ObjectClass, resultOut))
+    {
+        return false;
+    }
+
+    const String* str = args[0].as<String>();
+    const String* sub = args[1].as<String>();
+    size_t start, end;
+    if (!getSearchRange(args, 2, str->size(), start, end, resultOut))
+        return false;
+
+    posOut = -1;
+    if (start > end)
+        return true;
+
+    const char* data = str->data();
+    const char* found =
+        FindBytes(data + start, end - start, sub->data(), sub->size());
+    if (found)
+        posOut = found - data;
+    return true;
+}
+
+static bool str_find(NativeArgs args, MutableTraced<Value> resultOut) {
+    int64_t pos;
+    if (!findSubstring(args, pos, resultOut))
+        return false;
+
+    resultOut = Integer::get(pos);
+    return true;
+}
+
+static bool str_index(NativeArgs args, MutableTraced<Value> resultOut) {
+    int64_t pos;
+    if (!findSubstring(args, pos, resultOut))
+        return false;
+
+    if (pos == -1)
+        return Raise<ValueError>("substring not found", resultOut);
+
+    resultOut = Integer::get(pos);
+    return true;
+}
+
+static bool str_count(NativeArgs args, MutableTraced<Value> resultOut) {
+    if (!checkInstanceOf(args[0], String::ObjectClass, resultOut) ||
+        !checkInstanceOf(args[1], String::ObjectClass, resultOut))
+    {
+        return false;
+    }
+
+    const String* str = args[0].as<String>();
+    const String* sub = args[1].as<String>();
+    size_t start, end;
+    if (!getSearchRange(args, 2, str->size(), start, end, resultOut))
+        return false;
+
+    size_t count = 0;
+    if (start <= end) {
+        if (sub->size() == 0) {
+            count = end - start + 1;
+        } else {
+            count = CountBytes(str->data() + start, end - start,
+                               sub->data(), sub->size());
+        }
+    }
+
+    resultOut = Integer::get(int64_t(count));
+    return true;
+}
+
+static bool str_replace(NativeArgs args, MutableTraced<Value> resultOut) {
+    if (!checkInstanceOf(args[0], String::ObjectClass, resultOut) ||
+        !checkInstanceOf(args[1], String::ObjectClass, resultOut) ||
+        !checkInstanceOf(args[2], String::ObjectClass, resultOut))
+    {
+        return false;
+    }
+
+    int32_t maxCount = -1;
+    if (args.size() == 4) {
+        if (!args[3].isInt() || !args[3].toInt32(maxCount))
+            return Raise<TypeError>("count must be an integer", resultOut);
+    }
+
+    const String* str = args[0].as<String>();
+    const String* from = args[1].as<String>();
+    const String* to = args[2].as<String>();
+    const char* data = str->data();
+    const char* end = data + str->size();
+    size_t limit = maxCount < 0 ? SIZE_MAX : size_t(maxCount);
+
+    size_t count;
+    if (from->size() == 0)
+        count = min(str->size() + 1, limit);
+    else
+        count = min(CountBytes(data, str->size(), from->data(), from->size()),
+                    limit);
+
+    if (count == 0) {
+        resultOut = args[0];
+        return true;
+    }
+
+    string result;
+    result.reserve(str->size() + count * to->size() - count * from->size());
+    const char* p = data;
+    for (size_t i = 0; i < count; i++) {
+        if (from->size() == 0) {
+            // Insert before every character and at the end.
+            result.append(to->data(), to->size());
+            if (p != end)
+                result += *p++;
+            continue;
+        }
+
+        const char* found = FindBytes(p, end - p, from->data(), from->size());
+        assert(found);
+        result.append(p, found - p);
+        result.append(to->data(), to->size());
+        p = found + from->size();
+    }
+    result.append(p, end - p);
+
+    resultOut = String::get(result);
+    return true;
+}
+
+// Implement startswith and endswith.  The prefix may be a tuple of strings.
+template <bool AtEnd>
+static bool matchAffix(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], String::ObjectClass, resultOut))
+        return false;
+
+    const String* str = args[0].as<String>();
+    size_t start, end;
+    if (!getSearchRange(args, 2, str->size(), start, end, resultOut))
+        return false;
+
+    Stack<Value> affixes(args[1]);
+    bool isTuple = affixes.isInstanceOf(Tuple::ObjectClass);
+    size_t count = isTuple ? affixes.as<Tuple>()->len() : 1;
+    for (size_t i = 0; i < count; i++) {
+        Value value = isTuple ? affixes.as<Tuple>()->getitem(i) : affixes.get();
+        if (!value.isInstanceOf(String::ObjectClass)) {
+            return Raise<TypeError>(
+                AtEnd ? "endswith arg must be str or a tuple of str"
+                      : "startswith arg must be str or a tuple of str",
+                resultOut);
+        }
+
+        const String* affix = value.as<String>();
+        if (start > end || end - start < affix->size())
+            continue;
+
+        size_t pos = AtEnd ? end - affix->size() : start;
+        if (memcmp(str->data() + pos, affix->data(), affix->size()) == 0) {
+            resultOut = Boolean::True;
+            return true;
+        }
+    }
+
+    resultOut = Boolean::False;
+    return true;
+}
+
+static bool str_startswith(NativeArgs args, MutableTraced<Value> resultOut) {
+    return matchAffix<false>(args, resultOut);
+}
+
+static bool str_endswith(NativeArgs args, MutableTraced<Value> resultOut) {
+    return matchAffix<true>(args, resultOut);
+}
+
+// Implement strip, lstrip and rstrip.
+template <bool Left, bool Right>
+static bool stripChars(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], String::ObjectClass, resultOut))
+        return false;
+
+    const String* chars = nullptr;
+    if (args.size() == 2 && args[1] != Value(None)) {
+        if (!checkInstanceOf(args[1], String::ObjectClass, resultOut))
+            return false;
+        chars = args[1].as<String>();
+    }
+
+    auto shouldStrip = [=] (char c) {
+        if (!chars)
+            return isSpace(c);
+        return memchr(chars->data(), c, chars->size()) != nullptr;
+    };
+
+    const String* str = args[0].as<String>();
+    const char* begin = str->data();
+    const char* end = begin + str->size();
+    if (Left) {
+        while (begin != end && shouldStrip(*begin))
+            begin++;
+    }
+    if (Right) {
+        while (end != begin && shouldStrip(end[-1]))
+            end--;
+    }
+
+    if (size_t(end - begin) == str->size()) {
+        resultOut = args[0];
+        return true;
+    }
+
+    Stack<String*> self(args[0].as<String>());
+    resultOut = String::getSlice(self, begin - str->data(), end - begin);
+    return true;
+}
+
+// Implement upper and lower.  Only ASCII characters are converted.
+template <char From, char To>
+static bool convertCase(NativeArgs args, MutableTraced<Value> resultOut)
+{
+    if (!checkInstanceOf(args[0], String::ObjectClass, resultOut))
+        return false;
+
+    const String* str = args[0].as<String>();
+    const char* data = str->data();
+    size_t length = str->size();
+    auto shouldConvert = [] (char c) {
+        return c >= From && c < From + 26;
+    };
+
+    if (std::none_of(data, data + length, shouldConvert)) {
+        resultOut = args[0];
+        return true;
+    }
+
+    string result(data, length);
+    for (char& c : result) {
+        if (shouldConvert(c))
+            c += To - From;
+    }
+
+    resultOut = String::get(result);
+    return true;
+}
+
 static bool str_split(NativeArgs args, MutableTraced<Value> resultOut) {
     if (!checkInstanceOf(args[0], String::ObjectClass, resultOut))
         return false;
 
-    const string& str = args[0].as<String>()->value();
+    Stack<String*> str(args[0].as<String>());
+    Stack<String*> sep;
+    if (args.size() >= 2 && args[1] != Value(None)) {
+        if (!checkInstanceOf(args[1], String::ObjectClass, resultOut))
+            return false;
+        sep = args[1].as<String>();
+        if (sep->size() == 0)
+            return Raise<ValueError>("empty separator", resultOut);
+    }
+
+    int32_t maxSplit = -1;
+    if (args.size() == 3) {
+        if (!args[2].isInt() || !args[2].toInt32(maxSplit))
+            return Raise<TypeError>("maxsplit must be an integer", resultOut);
+    }
+    size_t limit = maxSplit < 0 ? SIZE_MAX : size_t(maxSplit);
+
     Stack<List*> result(List::getUninitialised(0));
     Stack<Value> value;
-
-    if (args.size() == 1) {
-        // Split on whitespace.
-        // todo: check whether this matches python's concept of whitespace.
-        const string spaces = " \t\n\r";
-        size_t pos = str.find_first_not_of(spaces, 0);
-        size_t last = pos;
-        while (pos = str.find_first_of(spaces, pos), pos != string::npos) {
-            value = gc.create<String>(str.substr(last, pos - last));
-            result->append(value);
-            pos = str.find_first_not_of(spaces, pos);
-            last = pos;
-        }
-        if (last != string::npos) {
-            value = gc.create<String>(str.substr(last, pos - last));
+    const char* p = str->data();
+    const char* end = p + str->size();
+
+    if (!sep) {
+        // Split on runs of whitespace, ignoring leading whitespace.  Trailing
+        // whitespace is kept if the split limit is reached.
+        for (size_t splits = 0; ; splits++) {
+            while (p != end && isSpace(*p))
+                p++;
+            if (p == end)
+                break;
+
+            const char* word = p;
+            if (splits == limit) {
+                p = end;
+            } else {
+                while (p != end && !isSpace(*p))
+                    p++;
+            }
+
+            value = String::getSlice(str, word - str->data(), p - word);
             result->append(value);
         }
 
@@ -166,24 +463,61 @@ static bool str_split(NativeArgs args, MutableTraced<Value> resultOut) {
         return true;
     }
 
-    if (!checkInstanceOf(args[1], String::ObjectClass, resultOut))
-        return false;
+    for (size_t splits = 0; splits < limit; splits++) {
+        const char* found = FindBytes(p, end - p, sep->data(), sep->size());
+        if (!found)
+            break;
 
-    const string& sep = args[1].as<String>()->value();
-    size_t pos = 0;
-    size_t last = 0;
-    while (pos = str.find(sep, pos), pos != string::npos) {
-        value = gc.create<String>(str.substr(last, pos - last));
+        value = String::getSlice(str, p - str->data(), found - p);
         result->append(value);
-        pos += sep.size();
-        last = pos;
+        p = found + sep->size();
     }
-    value = gc.create<String>(str.substr(last, pos - last));
+    value = String::getSlice(str, p - str->data(), end - p);
     result->append(value);
+
     resultOut = Value(result);
     return true;
 }
 
+template <typename S>
+static bool joinParts(Traced<String*> sep, Traced<S*> parts,
+                      MutableTraced<Value> resultOut)
+{
+    for (int32_t i = 0; i < parts->len(); i++) {
+        if (!parts->getitem(i).template is<String>())
+            return Raise<TypeError>("Expecting string", resultOut);
+    }
+
+    resultOut = String::join(sep, parts);
+    return true;
+}
+
+static bool str_join(NativeArgs args, MutableTraced<Value> resultOut) {
+    if (!checkInstanceOf(args[0], String::ObjectClass, resultOut))
+        return false;
+
+    Stack<String*> sep(args[0].as<String>());
+    Stack<Value> seq(args[1]);
+    if (!seq.isInstanceOf(List::ObjectClass) &&
+        !seq.isInstanceOf(Tuple::ObjectClass))
+    {
+        Stack<Value> list;
+        if (!interp->call(IterableToList, seq, list)) {
+            resultOut = list;
+            return false;
+        }
+        seq = list;
+    }
+
+    if (seq.isInstanceOf(Tuple::ObjectClass)) {
+        Stack<Tuple*> parts(seq.as<Tuple>());
+        return joinParts<Tuple>(sep, parts, resultOut);
+    }
+
+    Stack<List*> parts(seq.as<List>());
+    return joinParts<List>(sep, parts, resultOut);
+}
+
 GlobalRoot<Class*> String::ObjectClass;
 GlobalRoot<String*> String::EmptyString;
 
@@ -212,33 +546,228 @@ void String::init()
     initNativeMethod(ObjectClass, "__hash__", str_hash, 1);
     initNativeMethod(ObjectClass, "__contains__", str_contains, 2);
     initNativeMethod(ObjectClass, "_print", str_print, 1);
-    initNativeMethod(ObjectClass, "split", str_split, 1, 2);
+    initNativeMethod(ObjectClass, "split", str_split, 1, 3);
+    initNativeMethod(ObjectClass, "find", str_find, 2, 4);
+    initNativeMethod(ObjectClass, "index", str_index, 2, 4);
+    initNativeMethod(ObjectClass, "count", str_count, 2, 4);
+    initNativeMethod(ObjectClass, "replace", str_replace, 3, 4);
+    initNativeMethod(ObjectClass, "startswith", str_startswith, 2, 4);
+    initNativeMethod(ObjectClass, "endswith", str_endswith, 2, 4);
+    initNativeMethod(ObjectClass, "strip", stripChars<true, true>, 1, 2);
+    initNativeMethod(ObjectClass, "lstrip", stripChars<true, false>, 1, 2);
+    initNativeMethod(ObjectClass, "rstrip", stripChars<false, true>, 1, 2);
+    initNativeMethod(ObjectClass, "upper", convertCase<'a', 'A'>, 1);
+    initNativeMethod(ObjectClass, "lower", convertCase<'A', 'a'>, 1);
+    initNativeMethod(ObjectClass, "join", str_join, 2);
 
     EmptyString.init(Names::emptyString);
 }
 
-String::String(const string& v)
-  : Object(ObjectClass), value_(v)
-{}
+String::String(size_t length)
+  : Object(ObjectClass),
+    hash_(NoHash),
+    length_(length),
+    storage_(Storage::Inline),
+    chars_(data_)
+{
+    alwaysTrue((length <= MaxLength));
+}
+
+String::String(StringBuffer* buffer, size_t offset, size_t length)
+  : Object(ObjectClass),
+    hash_(NoHash),
+    length_(length),
+    storage_(Storage::Buffer),
+    chars_(buffer->data() + offset),
+    owner_(buffer)
+{
+    alwaysTrue((length <= MaxLength));
+    assert(offset + length <= buffer->used());
+}
 
-String::String(Traced<Class*> cls)
-  : Object(cls)
+String::String(String* parent, size_t offset, size_t length)
+  : Object(ObjectClass),
+    hash_(NoHash),
+    length_(length),
+    storage_(Storage::Parent),
+    chars_(parent->data_ + offset),
+    owner_(parent)
 {
-    assert(cls);
-    assert(cls->isDerivedFrom(ObjectClass));
+    assert(parent->storage_ == Storage::Inline);
+    assert(offset + length <= parent->length_);
 }
 
-String* String::get(const string& v)
+/* static */ String* String::getUninitialised(size_t length)
 {
-    if (v == "")
+    size_t size = sizeof(String) + length;
+    return gc.createSized<String>(size, length);
+}
+
+/* static */ StringBuffer* StringBuffer::get(size_t capacity)
+{
+    size_t size = sizeof(StringBuffer) + capacity;
+    return gc.createSized<StringBuffer>(size, capacity);
+}
+
+/* static */ String* String::create(const char* data, size_t length)
+{
+    String* s = getUninitialised(length);
+    memcpy(s->data_, data, length);
+    return s;
+}
+
+/* static */ String* String::get(const char* data, size_t length)
+{
+    if (length == 0)
         return EmptyString;
     // todo: can intern short strings here
-    return gc.create<String>(v);
+    return create(data, length);
+}
+
+/* static */ String* String::get(const string& v)
+{
+    return get(v.data(), v.size());
+}
+
+/* static */ String* String::concat(Traced<String*> a, Traced<String*> b)
+{
+    if (a->size() == 0)
+        return b;
+    if (b->size() == 0)
+        return a;
+
+    String* s = getUninitialised(a->size() + b->size());
+    memcpy(s->data_, a->chars_, a->length_);
+    memcpy(s->data_ + a->length_, b->chars_, b->length_);
+    return s;
+}
+
+/* static */ String* String::append(Traced<String*> a, Traced<String*> b)
+{
+    size_t length = a->length_ + b->length_;
+    if (b->length_ == 0 || length < MinBufferedLength)
+        return concat(a, b);
+
+    Stack<StringBuffer*> buffer(a->buffer());
+    size_t offset;
+    if (buffer && buffer->canExtend(a->chars_ + a->length_, b->length_)) {
+        offset = a->chars_ - buffer->data();
+    } else {
+        buffer = StringBuffer::get(length * 2);
+        buffer->extend(a->chars_, a->length_);
+        offset = 0;
+    }
+    buffer->extend(b->chars_, b->length_);
+    return gc.create<String>(buffer, offset, length);
+}
+
+template <typename S>
+/* static */ String* String::join(Traced<String*> sep, Traced<S*> parts)
+{
+    int32_t count = parts->len();
+    if (count == 0)
+        return EmptyString;
+
+    size_t length = sep->length_ * (count - 1);
+    for (int32_t i = 0; i < count; i++)
+        length += parts->getitem(i).template as<String>()->length_;
+    if (length == 0)
+        return EmptyString;
+
+    String* result = getUninitialised(length);
+    char* out = result->data_;
+    for (int32_t i = 0; i < count; i++) {
+        if (i != 0) {
+            memcpy(out, sep->chars_, sep->length_);
+            out += sep->length_;
+        }
+        String* part = parts->getitem(i).template as<String>();
+        memcpy(out, part->chars_, part->length_);
+        out += part->length_;
+    }
+    assert(out == result->data_ + length);
+    return result;
+}
+
+/* static */ String* String::getSlice(Traced<String*> s, size_t start,
+                                     size_t length)
+{
+    assert(start + length <= s->length_);
+    if (length == s->length_)
+        return s;
+    if (length == 0)
+        return EmptyString;
+
+    const char* chars = s->chars_ + start;
+    if (length < MinSharedSliceLength)
+        return create(chars, length);
+
+    // Share the storage that owns the characters, which is never itself a
+    // slice.
+    size_t ownerLength;
+    switch (s->storage_) {
+      case Storage::Inline:
+        ownerLength = s->length_;
+        break;
+      case Storage::Buffer:
+        ownerLength = s->buffer()->used();
+        break;
+      case Storage::Parent:
+        ownerLength = static_cast<String*>(s->owner_.get())->length_;
+        break;
+    }
+
+    // Copy instead if this would retain a much larger string.  Repeatedly
+    // slicing off the front of a string still copies only a linear amount
+    // overall, since each copy is at most a quarter of the previous one.
+    if (length * MaxSliceRetention < ownerLength)
+        return create(chars, length);
+
+    if (s->storage_ == Storage::Buffer) {
+        Stack<StringBuffer*> buffer(s->buffer());
+        return gc.create<String>(buffer, chars - buffer->data(), length);
+    }
+
+    Stack<String*> parent(s);
+    if (s->storage_ == Storage::Parent)
+        parent = static_cast<String*>(s->owner_.get());
+    return gc.create<String>(parent, chars - parent->data_, length);
+}
+
+void String::traceChildren(Tracer& t)
+{
+    Object::traceChildren(t);
+    gc.trace(t, &owner_);
+}
+
+int String::compare(const String* other) const
+{
+    int r = memcmp(chars_, other->chars_, min(length_, other->length_));
+    if (r != 0)
+        return r;
+    if (length_ == other->length_)
+        return 0;
+    return length_ < other->length_ ? -1 : 1;
+}
+
+size_t String::computeHash() const
+{
+    // FNV-1a, truncated to be non-negative so that the result of __hash__
+    // converts back to the same value.
+    // todo: should probably use python hash algorithm for this.
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length_; i++) {
+        hash ^= uint8_t(chars_[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash & INT64_MAX;
 }
 
 void String::print(ostream& s) const
 {
-    s << "'" << value_ << "'";
+    s << "'";
+    s.write(chars_, length_);
+    s << "'";
 }
 
 
@@ -249,7 +778,7 @@ static bool raiseOutOfRange(MutableTraced<Value> resultOut)
 
 bool String::getitem(Traced<Value> index, MutableTraced<Value> resultOut)
 {
-    size_t len = value_.size();
+    size_t len = length_;
     if (index.isInt()) {
         int32_t i;
         if (!index.toInt32(i))
@@ -257,7 +786,7 @@ bool String::getitem(Traced<Value> index, MutableTraced<Value> resultOut)
         i = WrapIndex(i, len);
         if (i < 0 || size_t(i) >= len)
             return raiseOutOfRange(resultOut);
-        resultOut = get(string(1, value_[i]));
+        resultOut = get(&chars_[i], 1);
         return true;
     } else if (index.isInstanceOf(Slice::ObjectClass)) {
         Stack<Slice*> slice(index.as<Slice>());
@@ -265,11 +794,17 @@ bool String::getitem(Traced<Value> index, MutableTraced<Value> resultOut)
         if (!slice->getIterationData(len, start, count, step, resultOut))
             return false;
 
+        if (step == 1) {
+            Stack<String*> self(this);
+            resultOut = getSlice(self, start, count);
+            return true;
+        }
+
         string result;
         int32_t src = start;
         for (size_t i = 0; i < count; i++) {
             assert(src < len);
-            result += value_[src];
+            result += chars_[src];
             src += step;
         }
 
@@ -3,10 +3,41 @@
 
 #include "object.h"
 
+#include <cstring>
 #include <string>
 
 struct InternedString;
 
+// Growable storage shared by strings built by repeated appending.  Each such
+// string refers to a prefix of the buffer.  Characters before used_ are never
+// modified, so only the string whose characters end at used_ can append in
+// place.
+struct StringBuffer : public Cell
+{
+    static StringBuffer* get(size_t capacity);
+
+    char* data() { return data_; }
+    size_t capacity() const { return capacity_; }
+    size_t used() const { return used_; }
+
+    bool canExtend(const char* end, size_t length) const {
+        return end == data_ + used_ && used_ + length <= capacity_;
+    }
+    void extend(const char* chars, size_t length) {
+        assert(used_ + length <= capacity_);
+        memcpy(data_ + used_, chars, length);
+        used_ += length;
+    }
+
+  private:
+    friend struct GC;
+    StringBuffer(size_t capacity) : capacity_(capacity), used_(0) {}
+
+    size_t capacity_;
+    size_t used_;
+    char data_[0];
+};
+
 struct String : public Object
 {
     static void init();
@@ -16,17 +47,108 @@ struct String : public Object
     static GlobalRoot<String*> EmptyString;
 
     static String* get(const string& v);
+    static String* get(const char* data, size_t length);
+
+    // Get a string containing the concatenation of a and b.
+    static String* concat(Traced<String*> a, Traced<String*> b);
+
+    // As concat, but for augmented assignment.  The result is built in a
+    // StringBuffer with spare capacity so that appending to it again does not
+    // need to copy a, making repeated appends linear overall.
+    static String* append(Traced<String*> a, Traced<String*> b);
+
+    // Join the strings in parts, which must all be strings, with sep.  S is
+    // List or Tuple.
+    template <typename S>
+    static String* join(Traced<String*> sep, Traced<S*> parts);
 
-    String(const string& v);
-    String(Traced<Class*> cls);
+    // Get the substring of length characters starting at start.  Large
+    // substrings share their characters with s rather than copying them.
+    static String* getSlice(Traced<String*> s, size_t start, size_t length);
+
+    // The characters are stored inline following the object, in a
+    // StringBuffer for strings created by append, or in another string for
+    // slices.  They are not null terminated.
+    const char* data() const { return chars_; }
+    size_t size() const { return length_; }
+    string value() const { return string(chars_, length_); }
+
+    // Compare values lexicographically, returning a negative number, zero or
+    // a positive number.
+    int compare(const String* other) const;
 
-    const string& value() const { return value_; }
     void print(ostream& s) const override;
 
+    // The hash is computed on first use and cached.  Interned strings have
+    // their hash computed when they are created.
+    size_t hash() const {
+        if (hash_ == NoHash)
+            hash_ = computeHash();
+        return hash_;
+    }
+
+    // Compare values, checking the cached hashes first if present.
+    bool equals(const String* other) const {
+        if (this == other)
+            return true;
+        if (hash_ != NoHash && other->hash_ != NoHash && hash_ != other->hash_)
+            return false;
+        return length_ == other->length_ &&
+               memcmp(chars_, other->chars_, length_) == 0;
+    }
+
     bool getitem(Traced<Value> index, MutableTraced<Value> resultOut);
 
+    void traceChildren(Tracer& t) override;
+
   private:
-    string value_;
+    // Hashes are truncated to be non-negative so this is never a valid hash.
+    static const size_t NoHash = SIZE_MAX;
+
+    static const size_t MaxLength = UINT32_MAX;
+
+    // Strings below this length are always stored inline.
+    static const size_t MinBufferedLength = 64;
+
+    // Slices below this length are copied, as are slices that would keep
+    // alive storage more than MaxSliceRetention times their own length.
+    static const size_t MinSharedSliceLength = 64;
+    static const size_t MaxSliceRetention = 4;
+
+    enum class Storage : uint8_t
+    {
+        Inline,
+        Buffer,     // owner_ is a StringBuffer
+        Parent      // owner_ is a String with inline storage
+    };
+
+    mutable size_t hash_;
+    uint32_t length_;
+    Storage storage_;
+    const char* chars_;
+    Heap<Cell*> owner_;
+    char data_[0];
+
+    friend struct GC;
+    friend struct InternedStringMap;
+    String(size_t length);
+    String(StringBuffer* buffer, size_t offset, size_t length);
+    String(String* parent, size_t offset, size_t length);
+
+    StringBuffer* buffer() const {
+        if (storage_ != Storage::Buffer)
+            return nullptr;
+        return static_cast<StringBuffer*>(owner_.get());
+    }
+
+    // Allocate a string with space for length characters, which the caller
+    // must fill in before the string is used.
+    static String* getUninitialised(size_t length);
+
+    // Allocate a new string, even if an equivalent one already exists.
+    static String* create(const char* data, size_t length);
+
+    size_t computeHash() const;
 };
 
 struct InternedString : public String
@@ -34,4 +156,7 @@ struct InternedString : public String
     InternedString() = delete;
 };
 
+// Convert a value to a string by calling its __str__ or __repr__ method.
+extern bool valueToString(Traced<Value> value, MutableTraced<Value> resultOut);
+
 #endif
@@ -55,9 +55,14 @@ void TestCase::runAllTests()
     runningTests = false;
 }
 
+bool testsMayAbort()
+{
+    return runningTests && !testExpectingException;
+}
+
 void maybeAbortTests(string what)
 {
-    if (runningTests && !testExpectingException)
+    if (testsMayAbort())
     {
         cerr << "Exception thrown in test: " << what << endl;
         assert(false);
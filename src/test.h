@@ -134,6 +134,9 @@ extern bool testExpectingException;
     }                                                                             \
     testExpectingException = false
 
+// Whether maybeAbortTests() would abort, so callers can avoid building its
+// message in the common case.
+bool testsMayAbort();
 void maybeAbortTests(string what);
 
 #endif
@@ -78,6 +78,42 @@ testcase(block)
                     "Const 1, SetGlobal bar, Pop, "
                     "GetGlobal foo, GetGlobal bar, Is, Not, Return");
 
+    testBuildModule("foo = 1\n"
+                    "2 - - foo",
+                    "Const 1, SetGlobal foo, Pop, "
+                    "Const 2, GetGlobal foo, GetMethod __neg__, CallMethod 0, "
+                    "BinaryOp -, Return");
+
+    // Constant folding
     testBuildModule("2 - - 1",
-                    "Const 2, Const 1, GetMethod __neg__, CallMethod 0, BinaryOp -, Return");
+                    "Const 3, Return");
+
+    testBuildModule("(1 + 2, 3.5 * 2)",
+                    "Const, Return");
+
+    testBuildModule("if False:\n"
+                    "  foo = 1\n"
+                    "else:\n"
+                    "  foo = 2",
+                    "Const 2, SetGlobal foo, Return");
+
+    testBuildModule("foo = 1\n"
+                    "if not foo:\n"
+                    "  foo = 2\n"
+                    "elif 1 < 2:\n"
+                    "  foo = 3\n"
+                    "else:\n"
+                    "  foo = 4",
+                    "Const 1, SetGlobal foo, Pop, "
+                    "GetGlobal foo, Not, BranchIfFalse 4, "
+                    "Const 2, SetGlobal foo, BranchAlways 3, "
+                    "Const 3, SetGlobal foo, Return");
+
+    testBuildModule("while 0:\n"
+                    "  foo = 1",
+                    "Const, Return");
+
+    testBuildModule("raise 1\n"
+                    "foo = 2",
+                    "Const 1, Raise, Return");
 }
@@ -8,5 +8,14 @@ testcase(builtin)
 {
     testInterp("hasattr(1, 'foo')", "False");
     testInterp("hasattr(1, '__repr__')", "True");
-    testInterp("range(4, 7)", "[4, 5, 6]");
+    testInterp("range(4, 7)", "range(4, 7)");
+    testInterp("list(range(4, 7))", "[4, 5, 6]");
+    testInterp("len([1, 2, 3])", "3");
+    testInterp("max(1, 3, 2)", "3");
+    testInterp("min([3, 1, 2])", "1");
+    testInterp("sum((1, 2), 3)", "6");
+    testInterp("divmod(7, 2)", "(3, 1)");
+    testInterp("sorted((2, 3, 1))", "[1, 2, 3]");
+    testException("len(None)", "has no len()");
+    testException("min([])", "empty sequence");
 }
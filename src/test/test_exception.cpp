@@ -15,7 +15,7 @@ testcase(exception)
     exc = gc.create<Exception>(TypeError::ObjectClass, "baz");
     testEqual(exc->fullMessage(), "TypeError: baz");
 
-    Stack<String*> str(gc.create<String>("foo"));
+    Stack<String*> str(String::get("foo"));
     exc = gc.create<Exception>(TypeError::ObjectClass, str);
     testEqual(exc->fullMessage(), "TypeError: foo");
 
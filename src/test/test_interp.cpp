@@ -48,6 +48,25 @@ void testException(const string& input, const string& expected)
     }
 }
 
+void testTraceback(const string& input, const string& expected)
+{
+    Stack<Value> result;
+    Stack<Env*> globals;
+    bool ok = CompileModule(input, globals, result);
+    testTrue(ok);
+    Stack<Block*> block(result.as<CodeObject>()->block());
+    testExpectingException = true;
+    ok = interp->exec(block, result);
+    testExpectingException = false;
+    testFalse(ok);
+    string traceback = result.asObject()->as<Exception>()->traceback();
+    if (traceback.find(expected) == string::npos) {
+        cerr << "Expected traceback containing: " << expected << endl;
+        cerr << "But got: " << traceback << endl;
+        abortTests();
+    }
+}
+
 void testReplacement(const string& input,
                      const string& expected,
                      InstrCode initial,
@@ -316,7 +335,7 @@ testcase(interp)
               "foo('a', 'b')", "'ab'",
               Instr_AugAssignUpdate,
               Instr_BinaryOpInt_Add,
-              Instr_BinaryOpBuiltin);
+              Instr_AugAssignUpdate_String);
 
     testStubs("def foo(x, y):\n"
               "  x *= y\n"
@@ -327,6 +346,53 @@ testcase(interp)
               Instr_BinaryOpFloat_Mul,
               Instr_BinaryOpInt_Mul);
 
+    testStubs("def foo(x):\n"
+              "  t = 0\n"
+              "  for i in x:\n"
+              "    t = t + i\n"
+              "  return t",
+              "foo([1, 2])", "3",
+              "foo((3, 4))", "7",
+              Instr_IteratorNext,
+              Instr_IteratorNext_List,
+              Instr_IteratorNext_Tuple);
+
+    testStubs("def foo(x):\n"
+              "  t = 0\n"
+              "  for i in x:\n"
+              "    t = t + i\n"
+              "  return t",
+              "foo(range(3))", "3",
+              "foo({1: 0, 2: 0})", "3",
+              Instr_IteratorNext,
+              Instr_IteratorNext_Range,
+              Instr_IteratorNext_Dict);
+
+    testStubs("def foo(x):\n"
+              "  t = 0\n"
+              "  for i in x:\n"
+              "    t = t + i\n"
+              "  return t",
+              "foo({1, 2})", "3",
+              "foo((3, 4))", "7",
+              Instr_IteratorNext,
+              Instr_IteratorNext_Set,
+              Instr_IteratorNext_Tuple);
+
+    testStubs("def foo(x):\n"
+              "  t = 0\n"
+              "  for i in x:\n"
+              "    t = t + i\n"
+              "  return t\n"
+              "def gen(n):\n"
+              "  for i in range(n):\n"
+              "    yield i",
+              "foo(gen(3))", "3",
+              "foo([4])", "4",
+              Instr_IteratorNext,
+              Instr_IteratorNext_Generator,
+              Instr_IteratorNext_List);
+
     testReplacements("g = 1\n"
                      "def foo():\n"
                      "  return g",
@@ -420,9 +486,107 @@ testcase(interp)
 
     testException("raise Exception('an exception')", "an exception");
 
+    testTraceback("def foo():\n"
+                  "  raise StopIteration()\n"
+                  "foo()",
+                  "line 2");
+
     testInterp("a = []\n"
                "for i in (1, 2, 3):\n"
                "  a.append(i + 1)\n"
                "a\n",
                "[2, 3, 4]");
 }
+
+static void testOptimised(const string& input, const string& expected,
+                          InstrCode absent)
+{
+    Stack<Value> result;
+    Stack<Env*> globals;
+    bool ok = CompileModule(input, globals, result);
+    testTrue(ok);
+    Stack<Block*> block(result.as<CodeObject>()->block());
+    testTrue(block->findInstr(absent) == nullptr);
+    testInterp(input, expected);
+}
+
+testcase(fold)
+{
+    testOptimised("2 * 3", "6", Instr_BinaryOp);
+    testOptimised("2 * 3.5", "7", Instr_BinaryOp);
+    testOptimised("1 + 2 * 3 - 4", "3", Instr_BinaryOp);
+    testOptimised("2 ** 40", "1099511627776", Instr_BinaryOp);
+    testOptimised("-2 + 1", "-1", Instr_BinaryOp);
+    testOptimised("~1", "-2", Instr_CallMethod);
+    testOptimised("'a' + 'b'", "'ab'", Instr_BinaryOp);
+    testOptimised("2 < 3.5", "True", Instr_CompareOp);
+    testOptimised("not True", "False", Instr_Not);
+    testOptimised("not None", "True", Instr_Not);
+    testOptimised("(1, 'a', (2.5, None))", "(1, 'a', (2.5, None))",
+                  Instr_Tuple);
+    testOptimised("0 or 2", "2", Instr_Or);
+    testOptimised("1 and 2", "2", Instr_And);
+    testOptimised("1 if True else x", "1", Instr_BranchIfFalse);
+
+    testOptimised("if False:\n"
+                  "  x = 1\n"
+                  "else:\n"
+                  "  x = 2\n"
+                  "x", "2", Instr_BranchIfFalse);
+    testInterp("x = 1\n"
+               "if x == 0:\n"
+               "  x = 2\n"
+               "elif True:\n"
+               "  x = 3\n"
+               "else:\n"
+               "  x = 4\n"
+               "x", "3");
+    testOptimised("x = 0\n"
+                  "while 0:\n"
+                  "  x = 1\n"
+                  "x", "0", Instr_BranchAlways);
+    testInterp("x = 0\n"
+               "while True:\n"
+               "  x = x + 1\n"
+               "  if x == 3:\n"
+               "    break\n"
+               "x", "3");
+
+    // Folding must not change runtime behaviour for things that raise.
+    testException("1 << -1", "negative shift count");
+    testException("'a' + 1", "unsupported operand type");
+
+    testInterp("def foo():\n"
+               "  return 1\n"
+               "  return 2\n"
+               "foo()", "1");
+    testInterp("def foo():\n"
+               "  for i in (1, 2):\n"
+               "    break\n"
+               "    i = 3\n"
+               "  return i\n"
+               "foo()", "1");
+}
+
+testcase(range)
+{
+    testOptimised("t = 0\n"
+                  "for i in range(5):\n"
+                  "  t = t + i\n"
+                  "t", "10", Instr_GetIterator);
+    testOptimised("t = []\n"
+                  "for i in range(6, 0, -2):\n"
+                  "  t.append(i)\n"
+                  "t", "[6, 4, 2]", Instr_IteratorNext);
+    testInterp("t = 0\n"
+               "for i in range(2147483640, 2147483647, 4):\n"
+               "  t = t + 1\n"
+               "t", "2");
+    testInterp("range = lambda n: (n,)\n"
+               "t = 0\n"
+               "for i in range(3):\n"
+               "  t = t + i\n"
+               "t", "3");
+    testException("for i in range(1, 2, 0):\n"
+                  "  pass", "must not be zero");
+}
@@ -1,10 +1,15 @@
 #include "../list.h"
 
 #include "../interp.h"
+#include "../sort.h"
 #include "../test.h"
 
 #include "test_interp.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 testcase(tuple)
 {
     testInterp("()", "()");
@@ -48,3 +53,47 @@ testcase(list)
     testException("[][0]", "index out of range");
     testException("[1][1]", "index out of range");
 }
+
+testcase(timsort)
+{
+    // Sort pairs by their first element only, checking stability against
+    // std::stable_sort for random, presorted, reversed and partly sorted input.
+    using Pair = pair<int, int>;
+    auto less = [] (const Pair& a, const Pair& b) { return a.first < b.first; };
+    unsigned seed = 1;
+    for (size_t length : {0, 1, 2, 31, 64, 65, 200, 1000, 5000}) {
+        for (int pattern = 0; pattern < 4; pattern++) {
+            vector<Pair> data(length);
+            for (size_t i = 0; i < length; i++) {
+                seed = seed * 1103515245 + 12345;
+                int key = (seed >> 16) % 100;
+                if (pattern == 1)
+                    key = i / 3;
+                else if (pattern == 2)
+                    key = length - i / 3;
+                else if (pattern == 3 && i % 100 < 90)
+                    key = i;
+                data[i] = Pair(key, i);
+            }
+
+            vector<Pair> expected(data);
+            stable_sort(expected.begin(), expected.end(), less);
+            vector<Pair> buffer(length / 2);
+            TimSort(data.data(), length, buffer.data(), less);
+            testTrue(data == expected);
+        }
+    }
+
+    // An inconsistent comparison function must not break anything.
+    vector<int> data(1000);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i;
+    vector<int> buffer(data.size() / 2);
+    TimSort(data.data(), data.size(), buffer.data(), [&] (int a, int b) {
+        seed = seed * 1103515245 + 12345;
+        return (seed & 0x10000) != 0;
+    });
+    sort(data.begin(), data.end());
+    for (size_t i = 0; i < data.size(); i++)
+        testEqual(data[i], int(i));
+}
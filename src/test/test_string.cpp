@@ -1,5 +1,6 @@
 #include "../string.h"
 
+#include "../bytesearch.h"
 #include "../test.h"
 
 #include "test_interp.h"
@@ -12,3 +13,43 @@ testcase(string)
     testInterp("''", "''");
     testInterp("\"foo\" + 'bar'", "'foobar'");
 }
+
+static const char* naiveFind(const string& haystack, const string& needle)
+{
+    size_t pos = haystack.find(needle);
+    return pos == string::npos ? nullptr : haystack.data() + pos;
+}
+
+testcase(bytesearch)
+{
+    // Check needles at every position around the vector block boundaries.
+    for (size_t length = 0; length < 80; length++) {
+        string haystack(length, 'a');
+        for (size_t i = 0; i < length; i++)
+            haystack[i] = 'a' + i % 3;
+
+        for (size_t needleLength = 1; needleLength < 6; needleLength++) {
+            for (size_t pos = 0; pos + needleLength <= length; pos++) {
+                string copy = haystack;
+                for (size_t i = 0; i < needleLength; i++)
+                    copy[pos + i] = 'x' + i % 2;
+                string needle = copy.substr(pos, needleLength);
+                testEqual(FindBytes(copy.data(), length,
+                                    needle.data(), needleLength),
+                          naiveFind(copy, needle));
+            }
+
+            string missing(needleLength, 'z');
+            testEqual(FindBytes(haystack.data(), length,
+                                missing.data(), needleLength),
+                      (const char*)nullptr);
+        }
+    }
+
+    string text = "abcabcabxabc";
+    testEqual(FindBytes(text.data(), text.size(), "", 0), text.data());
+    testEqual(FindBytes(text.data(), text.size(), "abx", 3), text.data() + 6);
+    testEqual(CountBytes(text.data(), text.size(), "abc", 3), 3u);
+    testEqual(CountBytes(text.data(), text.size(), "b", 1), 4u);
+    testEqual(CountBytes("aaaa", 4, "aa", 2), 2u);
+}
@@ -361,3 +361,56 @@ testcase(vector)
     runVectorTests<InlineVector<Element, 4>>();
     runVectorTests<InlineVector<Element, 9>>();
 }
+
+static void testShrinkToFitMinCapacity()
+{
+    Vector<Element> v;
+    populate(v, 100);
+    v.erase(v.begin() + 10, v.end());
+    v.shrink_to_fit(50);
+    testTrue(v.capacity() >= 50);
+    testTrue(v.capacity() < 100);
+    checkContents(v, 10);
+}
+
+testcase(vectorShrinkToFit)
+{
+    testShrinkToFitMinCapacity();
+    testEqual(Element::Count, 0);
+}
+
+static void testSegmentedStack()
+{
+    SegmentedStack<Element, 4> s;
+    testTrue(s.empty());
+    testEqual(s.capacity(), 0);
+
+    for (int i = 0; i < 10; i++)
+        s.emplace_back(i);
+    testEqual(s.size(), 10);
+    testEqual(s.capacity(), 12);
+    testEqual(s.back(), 9);
+
+    // Growing doesn't move existing elements.
+    Element* first = &s[0];
+    for (int i = 10; i < 20; i++)
+        s.emplace_back(i);
+    testEqual(first, &s[0]);
+    for (int i = 0; i < 20; i++)
+        testEqual(s[i], i);
+
+    // One spare segment is kept when shrinking.
+    bool released = false;
+    while (s.size() > 8)
+        released |= s.pop_back();
+    testTrue(released);
+    testEqual(s.capacity(), 12);
+    testFalse(s.pop_back());
+    testEqual(s.back(), 6);
+}
+
+testcase(segmentedStack)
+{
+    testSegmentedStack();
+    testEqual(Element::Count, 0);
+}
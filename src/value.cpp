@@ -1,8 +1,14 @@
 #include "value-inl.h"
 
-#include "object.h"
+#include "callable.h"
 #include "exception.h"
 #include "interp.h"
+#include "list.h"
+#include "object.h"
+#include "singletons.h"
+#include "string.h"
+
+#include <cmath>
 
 RootVector<Value> EmptyValueArray(0);
 
@@ -52,39 +58,250 @@ bool Value::toSize(size_t& out) const
     return as<Integer>()->toUnsigned(out);
 }
 
+size_t HashInteger(const mpz_class& i)
+{
+    if (i.fits_slong_p())
+        return size_t(i.get_si());
+
+    size_t low = mpz_getlimbn(i.get_mpz_t(), 0);
+    return sgn(i) < 0 ? ~low : low;
+}
+
+size_t HashFloat(double d)
+{
+    // Integral values hash the same as the equivalent int.
+    if (isfinite(d) && d == trunc(d)) {
+        if (d >= -9223372036854775808.0 && d < 9223372036854775808.0)
+            return size_t(int64_t(d));
+
+        // Get the low bits of the magnitude without creating an Integer.
+        int exp;
+        double frac = frexp(fabs(d), &exp);
+        uint64_t mantissa = uint64_t(ldexp(frac, 53));
+        int shift = exp - 53;
+        size_t low = shift < 64 ? mantissa << shift : 0;
+        return d < 0 ? ~low : low;
+    }
+
+    union PunnedDouble {
+        double d;
+        uint64_t i;
+    };
+
+    PunnedDouble p = { d };
+    return p.i;
+}
+
+size_t HashIdentity(Object* object)
+{
+    return reinterpret_cast<uintptr_t>(object) >> 3;
+}
+
+// Convert the result of calling __hash__ to a hash code.
+static bool HashFromResult(Value result, size_t& hashOut)
+{
+    if (result.isInt32()) {
+        hashOut = size_t(result.asInt32());
+        return true;
+    }
+
+    if (!result.is<Integer>())
+        return false;
+
+    hashOut = HashInteger(result.as<Integer>()->value());
+    return true;
+}
+
 size_t ValueHash::operator()(Value vArg) const
 {
+    // Hash builtin types directly.  These must give the same results as their
+    // __hash__ methods.
+    if (vArg.isInt32())
+        return size_t(vArg.asInt32());
+    if (vArg.isDouble())
+        return HashFloat(vArg.asDouble());
+
+    Object* object = vArg.asObject();
+    Class* cls = object->type();
+    if (cls == String::ObjectClass)
+        return object->as<String>()->hash();
+    if (cls == Integer::ObjectClass)
+        return HashInteger(object->as<Integer>()->value());
+    if (cls == Boolean::ObjectClass)
+        return object == Boolean::True ? 1 : 0;
+    if (cls == Float::ObjectClass)
+        return HashFloat(object->as<Float>()->value());
+    if (object == None)
+        return HashIdentity(object);
+    if (cls == Tuple::ObjectClass) {
+        Stack<Tuple*> tuple(object->as<Tuple>());
+        return tuple->hash();
+    }
+
     Stack<Value> value(vArg);
     Stack<Value> hashFunc;
     Stack<Value> result;
     if (!value.maybeGetAttr(Names::__hash__, hashFunc))
         ThrowException<TypeError>("Object has no __hash__ method");
 
+    // Objects that don't override __hash__ are hashed by identity.
+    if (hashFunc.is<Native>() && hashFunc.as<Native>()->func() == object_hash)
+        return HashIdentity(object);
+
     if (!interp->call(hashFunc, value, result))
         throw PythonException(result);
 
-    if (result.isInt32())
-        return result.asInt32();
-
-    if (!result.is<Integer>())
+    size_t hash;
+    if (!HashFromResult(result, hash))
         ThrowException<TypeError>("__hash__ method should return an int");
 
-    return result.as<Integer>()->value().get_ui(); // todo: truncates result
+    return hash;
 }
 
-bool ValuesEqual::operator()(Value a, Value b) const
+enum class BuiltinKind
+{
+    Int,
+    Float,
+    String,
+    Tuple,
+    Other
+};
+
+static BuiltinKind GetBuiltinKind(Value value)
+{
+    if (value.isInt32())
+        return BuiltinKind::Int;
+    if (value.isDouble())
+        return BuiltinKind::Float;
+
+    Class* cls = value.asObject()->type();
+    if (cls == Integer::ObjectClass || cls == Boolean::ObjectClass)
+        return BuiltinKind::Int;
+    if (cls == Float::ObjectClass)
+        return BuiltinKind::Float;
+    if (cls == String::ObjectClass)
+        return BuiltinKind::String;
+    if (cls == Tuple::ObjectClass)
+        return BuiltinKind::Tuple;
+    return BuiltinKind::Other;
+}
+
+static bool IntsEqual(Value a, Value b)
+{
+    if (a.isInt32() && b.isInt32())
+        return a.asInt32() == b.asInt32();
+
+    // Booleans are Integers with value 0 or 1.
+    if (a.isInt32())
+        return cmp(b.as<Integer>()->value(), a.asInt32()) == 0;
+    if (b.isInt32())
+        return cmp(a.as<Integer>()->value(), b.asInt32()) == 0;
+    return cmp(a.as<Integer>()->value(), b.as<Integer>()->value()) == 0;
+}
+
+static bool IntAndFloatEqual(Value i, double d)
+{
+    if (isnan(d))
+        return false;
+
+    if (i.isInt32())
+        return double(i.asInt32()) == d;
+
+    return cmp(i.as<Integer>()->value(), d) == 0;
+}
+
+bool MaybeCompareBuiltins(Value a, Value b, bool& equalOut)
+{
+    if (a == b) {
+        equalOut = true;
+        return true;
+    }
+
+    BuiltinKind ka = GetBuiltinKind(a);
+    BuiltinKind kb = GetBuiltinKind(b);
+    if (ka == BuiltinKind::Other || kb == BuiltinKind::Other) {
+        // None is only equal to itself.
+        bool aIsNone = a.isObject() && a.asObject() == None;
+        bool bIsNone = b.isObject() && b.asObject() == None;
+        if ((aIsNone && kb != BuiltinKind::Other) ||
+            (bIsNone && ka != BuiltinKind::Other) ||
+            (aIsNone && bIsNone))
+        {
+            equalOut = false;
+            return true;
+        }
+        return false;
+    }
+
+    if (ka == BuiltinKind::Int && kb == BuiltinKind::Int) {
+        equalOut = IntsEqual(a, b);
+    } else if (ka == BuiltinKind::Float && kb == BuiltinKind::Float) {
+        equalOut = a.toFloat() == b.toFloat();
+    } else if (ka == BuiltinKind::Int && kb == BuiltinKind::Float) {
+        equalOut = IntAndFloatEqual(a, b.toFloat());
+    } else if (ka == BuiltinKind::Float && kb == BuiltinKind::Int) {
+        equalOut = IntAndFloatEqual(b, a.toFloat());
+    } else if (ka != kb) {
+        equalOut = false;
+    } else if (ka == BuiltinKind::String) {
+        equalOut = a.as<String>()->equals(b.as<String>());
+    } else {
+        assert(ka == BuiltinKind::Tuple);
+        Tuple* ta = a.as<Tuple>();
+        Tuple* tb = b.as<Tuple>();
+        if (ta->len() != tb->len()) {
+            equalOut = false;
+            return true;
+        }
+        for (int32_t i = 0; i < ta->len(); i++) {
+            bool equal;
+            if (!MaybeCompareBuiltins(ta->getitem(i), tb->getitem(i), equal))
+                return false;
+            if (!equal) {
+                equalOut = false;
+                return true;
+            }
+        }
+        equalOut = true;
+    }
+
+    return true;
+}
+
+// Call a's __eq__ method, returning false if it is not present or returns
+// NotImplemented.
+static bool MaybeCallEq(Traced<Value> a, Traced<Value> b, bool& equalOut)
 {
-    Stack<Value> result;
     Stack<Value> eqFunc;
     if (!a.maybeGetAttr(Names::__eq__, eqFunc))
-        ThrowException<TypeError>("Object has no __eq__ method");
+        return false;
 
+    Stack<Value> result;
     if (!interp->call(eqFunc, a, b, result))
         throw PythonException(result);
 
+    if (result == Value(NotImplemented))
+        return false;
+
     Stack<Object*> obj(result.toObject());
     if (!obj->is<Boolean>())
         ThrowException<TypeError>("__eq__ method should return a bool");
 
-    return obj->as<Boolean>()->boolValue();
+    equalOut = obj->as<Boolean>()->boolValue();
+    return true;
+}
+
+bool ValuesEqual::operator()(Value aArg, Value bArg) const
+{
+    bool equal;
+    if (MaybeCompareBuiltins(aArg, bArg, equal))
+        return equal;
+
+    // Fall back to identity if neither side implements the comparison.
+    Stack<Value> a(aArg);
+    Stack<Value> b(bArg);
+    if (MaybeCallEq(a, b, equal) || MaybeCallEq(b, a, equal))
+        return equal;
+
+    return false;
 }
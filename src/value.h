@@ -165,6 +165,16 @@ struct ValuesEqual {
     bool operator()(Value a, Value b) const;
 };
 
+// Compare builtin values without running any python code.  Returns false if
+// the result depends on calling an __eq__ method.
+bool MaybeCompareBuiltins(Value a, Value b, bool& equalOut);
+
+// Hash codes for builtin types.  Equal numbers hash the same regardless of
+// their type.
+size_t HashInteger(const mpz_class& i);
+size_t HashFloat(double d);
+size_t HashIdentity(Object* object);
+
 ostream& operator<<(ostream& s, const Value& v);
 
 #endif
@@ -9,6 +9,7 @@
 
 #include "assert.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <iterator>
@@ -166,7 +167,6 @@ struct VectorStorageBase
     }
 
     size_t capacity() const {
-        assert(capacity_ < 10000);
         return capacity_;
     }
 
@@ -222,11 +222,17 @@ struct VectorStorageInline : public VectorStorageBase<T>
 
     template <size_t N>
     void initInlineData(uint8_t (&inlineData)[N]) {
-        assert(capacity() == 0);
-        assert(inlineCapacity_ == 0);
         assert(static_cast<void*>(&inlineData[0]) ==
                static_cast<void*>(this + 1));
-        this->inlineCapacity_ = N / sizeof(T);
+        initInlineCapacity(N / sizeof(T));
+    }
+
+    // Use storage for |count| elements immediately following this object. The
+    // caller is responsible for allocating this.
+    void initInlineCapacity(size_t count) {
+        assert(capacity() == 0);
+        assert(inlineCapacity_ == 0);
+        this->inlineCapacity_ = count;
         this->capacity_ = inlineCapacity_;
     }
 
@@ -462,7 +468,9 @@ struct VectorImpl : public VectorStorage
         construct_back(std::forward<Args>(args)...);
     }
 
-    void shrink_to_fit();
+    // Release unused heap storage, keeping space for at least |minCapacity|
+    // elements.
+    void shrink_to_fit(size_t minCapacity = 0);
 
     template <class InputIterator>
     void assign(InputIterator first, InputIterator last);
@@ -568,24 +576,25 @@ void VectorImpl<T, VectorStorage>::increaseCapacity(size_t newSize)
 }
 
 template <typename T, typename VectorStorage>
-void VectorImpl<T, VectorStorage>::shrink_to_fit()
+void VectorImpl<T, VectorStorage>::shrink_to_fit(size_t minCapacity)
 {
     assert(capacity() >= inlineCapacity());
 
+    size_t required = std::max(size(), minCapacity);
     if (heapCapacity() == 0 ||
-        (heapCapacity() == InitialHeapCapacity && size() > inlineCapacity()))
+        (heapCapacity() == InitialHeapCapacity && required > inlineCapacity()))
     {
         return;
     }
 
     size_t newHeapCapacity = 0;
-    if (size() > inlineCapacity()) {
+    if (required > inlineCapacity()) {
         newHeapCapacity = InitialHeapCapacity;
-        while (newHeapCapacity + inlineCapacity() < size())
+        while (newHeapCapacity + inlineCapacity() < required)
             newHeapCapacity += newHeapCapacity / 2;
     }
 
-    if (newHeapCapacity != heapCapacity())
+    if (newHeapCapacity < heapCapacity())
         changeHeapCapacity(newHeapCapacity);
 }
 
@@ -708,4 +717,89 @@ void VectorImpl<T, VectorStorage>::assign(size_t newSize, const T& fillValue)
         construct_back(fillValue);
 }
 
+// Stack with storage allocated in fixed size segments.
+//
+// Growing never moves existing elements, so pushing is constant time and
+// pointers to elements stay valid until they are popped. Trailing segments
+// are released as the stack shrinks, keeping one spare to avoid repeatedly
+// allocating and freeing when the size oscillates around a segment boundary.
+template <typename T, size_t SegmentSize>
+struct SegmentedStack
+{
+    static_assert((SegmentSize & (SegmentSize - 1)) == 0,
+                  "Segment size must be a power of two");
+
+    SegmentedStack()
+      : size_(0)
+    {}
+
+    ~SegmentedStack() {
+        while (size_ != 0)
+            ptr(--size_)->~T();
+        for (T* segment : segments_)
+            free(segment);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    size_t capacity() const {
+        return segments_.size() * SegmentSize;
+    }
+
+    T& operator[](size_t i) {
+        assert(i < size_);
+        return *ptr(i);
+    }
+
+    const T& operator[](size_t i) const {
+        assert(i < size_);
+        return *ptr(i);
+    }
+
+    T& back() {
+        assert(!empty());
+        return *ptr(size_ - 1);
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        if (size_ == capacity()) {
+            size_t bytes = sizeof(T) * SegmentSize;
+            segments_.push_back(static_cast<T*>(malloc(bytes)));
+        }
+        new (ptr(size_)) T(std::forward<Args>(args)...);
+        size_++;
+    }
+
+    // Remove the top element. Returns whether a segment was released.
+    bool pop_back() {
+        assert(!empty());
+        ptr(--size_)->~T();
+        if (capacity() - size_ < 2 * SegmentSize)
+            return false;
+
+        free(segments_.back());
+        segments_.pop_back();
+        return true;
+    }
+
+  private:
+    Vector<T*> segments_;
+    size_t size_;
+
+    T* ptr(size_t i) const {
+        assert(i < capacity());
+        return &segments_[i / SegmentSize][i % SegmentSize];
+    }
+
+    SegmentedStack(const SegmentedStack& other) = delete;
+    SegmentedStack& operator=(const SegmentedStack& other) = delete;
+};
+
 #endif
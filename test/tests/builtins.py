@@ -22,6 +22,11 @@ except TypeError:
     exception = True
 assert(exception)
 
+def generate():
+    yield 3
+    yield 1
+    yield 2
+
 def testIter(iterable):
     i = iter(iterable)
     assert(next(i) == 1)
@@ -54,11 +59,109 @@ assert(list(map(inc, [1, 2, 3])) == [2, 3, 4])
 assert(list(zip()) == [])
 assert(list(zip([1], [2])) == [(1, 2)])
 assert(list(zip([1, 2], [2, 3])) == [(1, 2), (2, 3)])
+assert(list(zip([1, 2, 3], (4, 5))) == [(1, 4), (2, 5)])
+assert(list(zip(range(3), 'ab')) == [(0, 'a'), (1, 'b')])
+assert(list(zip(generate(), [1])) == [(3, 1)])
+
+def add(a, b):
+    return a + b
+
+assert(list(map(add, [1, 2], (3, 4, 5))) == [4, 6])
+assert(list(map(inc, generate())) == [4, 2, 3])
+assert(list(map(inc, map(inc, range(2)))) == [2, 3])
+
+assert(list(enumerate([])) == [])
+assert(list(enumerate('ab')) == [(0, 'a'), (1, 'b')])
+assert(list(enumerate(['a'], 5)) == [(5, 'a')])
+assert(list(enumerate(['a', 'b'], 2147483647)) ==
+       [(2147483647, 'a'), (2147483648, 'b')])
+
+def isOdd(x):
+    return x % 2 == 1
+
+assert(list(filter(isOdd, range(6))) == [1, 3, 5])
+assert(list(filter(None, [0, 1, None, 2])) == [1, 2])
+assert(list(filter(isOdd, [])) == [])
+
+i = map(inc, [1, 2])
+assert(iter(i) is i)
+assert(next(i) == 2)
+assert(list(i) == [3])
+
+exception = False
+try:
+    zip(1)
+except TypeError:
+    exception = True
+assert(exception)
 
 assert(sum([]) == 0)
 assert(sum([1, 2, 3]) == 6)
 assert(sum((1, 2, 3), 4) == 10)
 
+assert(sum([1.5, 2]) == 3.5)
+assert(sum(range(5)) == 10)
+assert(sum([2147483647, 1]) == 2147483648)
+
+class Vector:
+    def __init__(self, x):
+        self.x = x
+    def __add__(self, other):
+        return Vector(self.x + other.x)
+assert(sum([Vector(1), Vector(2)], Vector(0)).x == 3)
+
+assert(max([1, 2.5, 2]) == 2.5)
+assert(min(generate()) == 1)
+assert(sorted(generate()) == [1, 2, 3])
+assert(max(range(4)) == 3)
+assert(max('abc') == 'c')
+assert(min(2, 1, 1.0) == 1)
+
+exception = False
+try:
+    max([])
+except ValueError:
+    exception = True
+assert(exception)
+
+assert(len([1, 2]) == 2)
+assert(len((1,)) == 1)
+assert(len('abc') == 3)
+assert(len({1: 2}) == 1)
+assert(len({1, 2, 3}) == 3)
+assert(len(range(0, 10, 2)) == 5)
+
+class Sized:
+    def __len__(self):
+        return 7
+assert(len(Sized()) == 7)
+
+exception = False
+try:
+    len(1)
+except TypeError:
+    exception = True
+assert(exception)
+
+assert(repr('a') == "'a'")
+assert(repr(1) == '1')
+assert(type(1) is int)
+assert(type(Sized()) is Sized)
+
+assert(sorted([3, 1, 2]) == [1, 2, 3])
+assert(sorted((3, 1, 2)) == [1, 2, 3])
+assert(sorted(range(3, 0, -1)) == [1, 2, 3])
+l = [2, 1]
+assert(sorted(l) is not l)
+assert(l == [2, 1])
+assert(sorted([3, 1, 2], reverse = True) == [3, 2, 1])
+assert(sorted(['bb', 'a', 'ccc'], key = len) == ['a', 'bb', 'ccc'])
+assert(sorted([1, 2, 3], key = lambda x: -x) == [3, 2, 1])
+
+i = iter([1])
+assert(next(i, 0) == 1)
+assert(next(i, 0) == 0)
+
 # todo: these tests are probably not sufficient
 assert(divmod(5, 2) == (2, 1))
 assert(divmod(4.5, 1.5) == (3.0, 0.0))
@@ -123,6 +226,16 @@ assert x['a'] == 1
 assert x['b'] == 2
 assert 'x' in x
 
+def locals5():
+    a = 1
+    b = 2
+    del a
+    return locals()
+x = locals5()
+assert 'a' not in x
+assert len(x.keys()) == 1
+assert len(x.values()) == 1
+
 # globals
 foo = 1
 g = globals()
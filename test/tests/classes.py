@@ -179,6 +179,113 @@ except OSError:
   threw = True
 assert threw
 
+# Test error thrown in constructor is caught at the right stack depth
+def construct(x):
+  total = 0
+  for i in range(3):
+    try:
+      total += x + Bad()
+    except OSError:
+      total += 1
+  return total
+assert construct(1) == 3
+
+# Test constructor returning something other than None
+class BadReturn:
+  def __init__(self):
+    return 1
+
+threw = False
+try:
+  BadReturn()
+except TypeError:
+  threw = True
+assert threw
+
+# Test constructor with many arguments and default arguments
+class Many:
+  def __init__(self, a, b, c, d, e, f, g, h, i = 9, j = 10):
+    self.total = a + b + c + d + e + f + g + h + i + j
+assert Many(1, 2, 3, 4, 5, 6, 7, 8).total == 55
+assert Many(1, 2, 3, 4, 5, 6, 7, 8, 0).total == 46
+assert Many(1, 2, 3, 4, 5, 6, 7, 8, 0, 0).total == 36
+
+# Test constructor called from native code
+class Wrapped:
+  def __init__(self, x):
+    self.x = x
+assert [w.x for w in map(Wrapped, [1, 2, 3])] == [1, 2, 3]
+
+# Test recursive constructors
+class Node:
+  def __init__(self, n):
+    self.next = Node(n - 1) if n else None
+n = Node(1000)
+count = 0
+while n:
+  count += 1
+  n = n.next
+assert count == 1001
+
+# Test inherited constructor is called
+class Base:
+  def __init__(self):
+    self.x = 1
+class Derived(Base):
+  pass
+assert Derived().x == 1
+
+# Test instances created after their class's layout has been predicted
+class Predicted:
+  y = 0
+  def __init__(self, x, y):
+    self.x = x
+    if y:
+      self.y = y
+
+for i in range(20):
+  p = Predicted(i, 1)
+  assert p.x == i and p.y == 1
+
+p = Predicted(1, 0)
+assert p.x == 1
+assert p.y == 0
+threw = False
+try:
+  del p.y
+except AttributeError:
+  threw = True
+assert threw
+p.y = 2
+assert p.y == 2
+del p.y
+assert p.y == 0
+p.z = 3
+assert p.z == 3
+
+# Test instances with differing layouts
+class Differing:
+  def __init__(self, i):
+    if i % 2:
+      self.a = i
+    else:
+      self.b = i
+
+for i in range(20):
+  d = Differing(i)
+  if i % 2:
+    assert d.a == i and not hasattr(d, 'b')
+  else:
+    assert d.b == i and not hasattr(d, 'a')
+
+# Test argument errors in constructor
+threw = False
+try:
+  Wrapped()
+except TypeError:
+  threw = True
+assert threw
+
 # decorators
 def d1(x):
     return 1
@@ -34,4 +34,206 @@ assert(len(a) == 50)
 for i in range(0, 100):
     assert (str(i) in a) == ((i % 2) != 0)
 
+def sortedKeys(d):
+    result = []
+    for k in d:
+        result.append(k)
+    return sorted(result)
+
+assert sortedKeys({}) == []
+assert sortedKeys({'b': 1, 'a': 2}) == ['a', 'b']
+assert sortedKeys({'b': 1, 'a': 2, 'c': 3}) == ['a', 'b', 'c']
+
+# Adding or removing keys during iteration raises RuntimeError
+def raisesDuringIteration(d, mutate):
+    try:
+        for k in d:
+            mutate(d, k)
+    except RuntimeError:
+        return True
+    return False
+
+def add(d, k):
+    d[k + 10] = 0
+def remove(d, k):
+    del d[k]
+def replace(d, k):
+    d[k + 10] = 0
+    del d[k]
+def update(d, k):
+    d[k] = k + 1
+
+assert raisesDuringIteration({1: 1, 2: 2}, add)
+assert raisesDuringIteration({1: 1, 2: 2}, remove)
+assert raisesDuringIteration({1: 1, 2: 2}, replace)
+assert not raisesDuringIteration({1: 1, 2: 2}, update)
+d = {1: 1}
+assert raisesDuringIteration(d, remove)
+assert d == {}
+
+# Iteration follows insertion order
+d = {'c': 1, 'a': 2, 'b': 3}
+assert list(d) == ['c', 'a', 'b']
+assert list(d.keys()) == ['c', 'a', 'b']
+assert list(d.values()) == [1, 2, 3]
+
+# Overwriting a key keeps its position, re-adding a deleted key moves it to
+# the end
+d['a'] = 4
+assert list(d) == ['c', 'a', 'b']
+del d['c']
+d['c'] = 5
+assert list(d) == ['a', 'b', 'c']
+assert list(d.values()) == [4, 3, 5]
+
+# Order is preserved as the dict grows and after many deletions
+d = {}
+for i in range(1000):
+    d[i] = i
+for i in range(0, 1000, 3):
+    del d[i]
+for i in range(0, 1000, 3):
+    d[i] = -i
+keys = list(d)
+assert len(keys) == 1000
+assert keys[:4] == [1, 2, 4, 5]
+assert keys[-2:] == [996, 999]
+assert d[999] == -999 and d[998] == 998
+
+# Repeated insertion and deletion doesn't grow the dict without bound
+d = {}
+for i in range(10000):
+    d[i] = i
+    del d[i]
+assert len(d) == 0
+d['x'] = 1
+assert list(d) == ['x']
+
+# Keys with the same hash and user defined equality
+class Key:
+    def __init__(self, x):
+        self.x = x
+    def __hash__(self):
+        return 1
+    def __eq__(self, other):
+        return isinstance(other, Key) and self.x == other.x
+
+d = {}
+for i in range(20):
+    d[Key(i)] = i
+assert len(d) == 20
+for i in range(20):
+    assert d[Key(i)] == i
+assert Key(20) not in d
+del d[Key(5)]
+assert Key(5) not in d
+assert len(d) == 19
+
+# Mixed key types
+t = (1, 2)
+d = {1: 'a', '1': 'b', None: 'd', t: 'e'}
+assert d[1] == 'a' and d['1'] == 'b'
+assert d[None] == 'd' and d[t] == 'e'
+assert d[-1 + 2] == 'a'
+assert d['' + '1'] == 'b'
+assert 2147483648 not in d
+d[2147483648] = 'f'
+assert d[2147483647 + 1] == 'f'
+
+# Equal numbers are the same key regardless of type
+d = {1: 'a'}
+d[1.0] = 'b'
+d[True] = 'c'
+assert len(d) == 1 and d[1] == 'c'
+assert list(d) == [1]
+d = {2 ** 40: 'a', 0.5: 'b', -2 ** 70: 'c'}
+assert d[float(2 ** 40)] == 'a'
+assert d[1 / 2] == 'b'
+assert d[float(-2 ** 70)] == 'c'
+assert 0 not in d and False not in d
+
+# Tuples are hashed by value
+d = {(1, 'a'): 1, (): 2, (1, (2, 3.5)): 3}
+assert d[(1, 'a')] == 1
+assert d[()] == 2
+assert d[(1.0, (2, 3.5))] == 3
+assert (1, 'b') not in d
+
+# Objects without __hash__ and __eq__ are compared by identity
+class Plain:
+    pass
+p = Plain()
+d = {p: 1, None: 2}
+assert d[p] == 1 and d[None] == 2
+assert Plain() not in d
+
+# __eq__ returning NotImplemented falls back to the other operand
+class Loose:
+    def __init__(self, x):
+        self.x = x
+    def __hash__(self):
+        return self.x
+    def __eq__(self, other):
+        if isinstance(other, Loose):
+            return self.x == other.x
+        return NotImplemented
+d = {Loose(1): 'a', 1: 'b'}
+assert len(d) == 2
+assert d[Loose(1)] == 'a' and d[1] == 'b'
+d = {(Loose(1), 2): 'c'}
+assert d[(Loose(1), 2)] == 'c'
+assert (Loose(2), 2) not in d
+
+# Hashing and comparing keys may grow the interpreter stack
+def deep(n):
+    return 0 if n == 0 else deep(n - 1)
+
+class DeepKey:
+    def __init__(self, x):
+        self.x = x
+    def __hash__(self):
+        return deep(200) + 1
+    def __eq__(self, other):
+        return deep(200) == 0 and self.x == other.x
+
+d = {}
+s = set()
+for i in range(5):
+    d[DeepKey(i)] = i
+    s.add(DeepKey(i))
+for i in range(5):
+    assert d[DeepKey(i)] == i
+    assert DeepKey(i) in d and DeepKey(i) in s
+del d[DeepKey(2)]
+s.remove(DeepKey(2))
+assert DeepKey(2) not in d and DeepKey(2) not in s
+assert len(d) == 4 and len(s) == 4
+
+# Comparing keys may modify the dict
+class Mutator:
+    def __init__(self, d, grow):
+        self.d = d
+        self.grow = grow
+    def __hash__(self):
+        return 7
+    def __eq__(self, other):
+        if self.grow:
+            for i in range(100, 120):
+                self.d[i] = i
+        else:
+            for k in list(self.d):
+                del self.d[k]
+        return False
+
+for grow in (True, False):
+    d = {}
+    d[Mutator(d, grow)] = 1
+    threw = False
+    try:
+        d[Mutator(d, grow)]
+    except KeyError:
+        threw = True
+    assert threw
+    assert len(d) == (21 if grow else 0)
+
 print('ok')
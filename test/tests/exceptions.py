@@ -183,4 +183,102 @@ except NameError as e:
     caught = True
 assert caught
 
+# Leaving a try block with break doesn't leave its handler active
+for i in range(3):
+    try:
+        break
+    except KeyError:
+        assert False
+caught = False
+try:
+    raise KeyError()
+except KeyError:
+    caught = True
+assert caught
+
+# Return and break from within loops inside try/finally
+def returnInLoop(x):
+    r = []
+    try:
+        for i in x:
+            for j in x:
+                if j == 2:
+                    return r
+                r.append(j)
+    finally:
+        r.append(-1)
+assert returnInLoop([1, 2]) == [1, -1]
+
+def breakInLoop(x):
+    r = []
+    for i in x:
+        try:
+            for j in x:
+                try:
+                    if j == 2:
+                        break
+                finally:
+                    r.append(j)
+            break
+        finally:
+            r.append(-1)
+    return r
+assert breakInLoop([1, 2, 3]) == [1, 2, -1]
+
+# Handlers in generators resumed at a different stack depth
+def genWithHandler():
+    try:
+        yield 1
+        raise KeyError()
+    except KeyError:
+        yield 2
+    try:
+        yield 3
+    finally:
+        yield 4
+
+def deeper(g, n):
+    if n == 0:
+        return next(g)
+    return deeper(g, n - 1)
+
+g = genWithHandler()
+assert next(g) == 1
+assert deeper(g, 5) == 2
+assert deeper(g, 2) == 3
+assert next(g) == 4
+
+# Iterators raising StopIteration
+class Countdown:
+    def __init__(self, n):
+        self.n = n
+    def __iter__(self):
+        return self
+    def __next__(self):
+        if self.n == 0:
+            raise StopIteration()
+        self.n -= 1
+        return self.n
+assert list(Countdown(3)) == [2, 1, 0]
+
+caught = False
+try:
+    raise StopIteration()
+except StopIteration as e:
+    caught = isinstance(e, StopIteration) and isinstance(e, Exception)
+assert caught
+
+try:
+    raise StopIteration("done")
+except StopIteration as e:
+    assert e.message == "done"
+
+# User code gets a fresh StopIteration each time
+def newStopIteration():
+    try:
+        raise StopIteration()
+    except StopIteration as e:
+        return e
+assert newStopIteration() is not newStopIteration()
+
 print('ok')
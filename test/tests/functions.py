@@ -88,6 +88,95 @@ def q(x):
     return foo
 assert(q(1) == 1)
 
+# closures capture only the variables referenced by nested scopes
+def s(a, b):
+    c = a + b
+    d = a * b
+    def s2(e):
+        return a + c + e
+    return s2(d)
+assert(s(2, 3) == 2 + 5 + 6)
+
+def t(x):
+    fs = []
+    for i in range(3):
+        fs.append(lambda: i + x)
+    return [f() for f in fs]
+assert(t(10) == [12, 12, 12])
+
+def u(x):
+    y = x + 1
+    def u2(z):
+        w = z + 1
+        def u3():
+            return x + y + w
+        return u3()
+    return u2(0)
+assert(u(1) == 1 + 2 + 1)
+
+def v():
+    x = 1
+    def v2():
+        return x
+    del x
+    try:
+        v2()
+    except NameError:
+        return True
+    return False
+assert(v())
+
+def w():
+    def w2():
+        return x
+    try:
+        w2()
+    except NameError:
+        return 'unbound'
+    x = 1
+assert(w() == 'unbound')
+
+def x(n):
+    class X:
+        value = n
+        def make(self):
+            return X()
+    return X().make().value
+assert(x(3) == 3)
+
+def y(f):
+    def wrapper(*args):
+        return f(*args) + 1
+    return wrapper
+@y
+def y2(a, b):
+    return a + b
+assert(y2(1, 2) == 4)
+
+def z(n):
+    total = 0
+    def add(k):
+        nonlocal total
+        total += k
+    for i in range(n):
+        add(i)
+    return total
+assert(z(5) == 10)
+
+def gen(n):
+    def scale(k):
+        return k * n
+    for i in range(n):
+        yield scale(i)
+assert(list(gen(3)) == [0, 3, 6])
+
+def loc(a):
+    b = 2
+    def loc2():
+        return a
+    return locals()
+assert(loc(1)['a'] == 1 and loc(1)['b'] == 2 and 'loc2' in loc(1))
+
 # default arguments
 def r(x, y = []):
     y.append(x)
@@ -125,6 +214,51 @@ def t(a, b = 2, c = 3):
 
 assert raisesException(lambda: t(), TypeError)
 
+# keyword calls from the same call site
+def kw1(a, b = 2, c = 3):
+    return a, b, c
+
+def kw2(z, b = 0, c = 0):
+    return c, b, z
+
+def makeKw(d):
+    def kw3(a, b, c = d):
+        return a, b, c
+    return kw3
+
+def callKw(f):
+    return f(1, c = 3, b = 2)
+
+for i in range(3):
+    assert callKw(kw1) == (1, 2, 3)
+assert callKw(kw2) == (3, 2, 1)
+assert callKw(kw1) == (1, 2, 3)
+assert raisesException(lambda: callKw(lambda a, b: 0), TypeError)
+assert raisesException(lambda: callKw(lambda a, c, b, d: 0), TypeError)
+
+def callKw2(f):
+    return f(b = 4)
+assert raisesException(lambda: callKw2(makeKw(5)), TypeError)
+
+def callKw3(f, x):
+    return f(x, b = 4)
+assert callKw3(makeKw(5), 1) == (1, 4, 5)
+assert callKw3(makeKw(6), 1) == (1, 4, 6)
+
+def callKwMapping(f, m):
+    return f(1, **m)
+assert callKwMapping(kw1, {'b': 2}) == (1, 2, 3)
+assert callKwMapping(kw1, {'c': 4}) == (1, 2, 4)
+assert callKwMapping(kw1, {'c': 4, 'b': 5}) == (1, 5, 4)
+assert raisesException(lambda: callKwMapping(kw1, {'a': 4}), TypeError)
+
+class KwMethods:
+    def m(self, a, b = 2):
+        return a, b
+k = KwMethods()
+for i in range(3):
+    assert k.m(b = 3, a = i) == (i, 3)
+
 def u(*a, b = 2, c = 3):
     return a, b, c
 
@@ -190,6 +324,46 @@ assert bb(0, 1, d = 9) == (0, (1,), 2, {'d': 9})
 assert bb(0, kw = 9) == (0, (), 2, {'kw': 9})
 badArgCount(lambda: bb())
 
+# forwarding unpacked arguments
+def fw1(*args, **kwargs):
+    kwargs['x'] = 1
+    return args, kwargs
+
+def fw2(*args):
+    return args
+
+def fw3(a, b = 2):
+    return a, b
+
+def forward(f, *args, **kwargs):
+    return f(*args, **kwargs)
+
+def forwardArgs(f, *args):
+    return f(*args)
+
+t = (1, 2)
+assert fw1(*t) == ((1, 2), {'x': 1})
+assert fw1(*t)[0] is t
+assert fw2(*[1, 2]) == (1, 2)
+assert fw2(*range(3)) == (0, 1, 2)
+assert forward(fw1, 1, y = 2) == ((1,), {'x': 1, 'y': 2})
+kw = {'y': 2}
+assert fw1(**kw) == ((), {'x': 1, 'y': 2})
+assert kw == {'y': 2}
+assert fw1(*t, **kw) == ((1, 2), {'x': 1, 'y': 2})
+assert forward(fw2, 1, 2) == (1, 2)
+assert forward(fw3, 1) == (1, 2)
+assert forward(fw3, 1, b = 3) == (1, 3)
+assert forwardArgs(fw3, 4, 5) == (4, 5)
+def fwGen():
+    yield 1
+    yield 2
+assert fw2(*fwGen()) == (1, 2)
+assert raisesException(lambda: forward(fw2, 1, y = 2), TypeError)
+assert raisesException(lambda: fw2(**{1: 2}), TypeError)
+assert raisesException(lambda: forwardArgs(fw3), TypeError)
+assert raisesException(lambda: fw2(*1), TypeError)
+
 # keyword splat, or whatever this is called
 
 def cc(a, b = -2, c = -3):
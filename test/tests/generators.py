@@ -43,4 +43,52 @@ def b():
 assert(collect(noExcept(a)) == [1])
 assert(collect(noExcept(b)) == [None])
 
+# Generators resumed directly by for loops
+def count(n):
+    i = 0
+    while i < n:
+        yield i
+        i += 1
+
+def total(iter):
+    t = 0
+    for x in iter:
+        t += x
+    return t
+
+assert total(count(5)) == 10
+assert total(count(0)) == 0
+
+g = count(5)
+for x in g:
+    if x == 2:
+        break
+assert next(g) == 3
+assert total(g) == 4
+assert total(g) == 0
+try:
+    next(g)
+    assert False
+except StopIteration:
+    pass
+
+def nested(n):
+    for i in count(n):
+        for j in count(i):
+            yield j
+
+assert collect(nested(4)) == [0, 0, 1, 0, 1, 2]
+
+def raises():
+    yield 1
+    raise KeyError()
+
+r = []
+try:
+    for x in raises():
+        r.append(x)
+except KeyError:
+    r.append(2)
+assert r == [1, 2]
+
 print('ok')
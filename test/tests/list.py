@@ -54,6 +54,78 @@ assert(a == [3, 1, 2])
 a.sort()
 assert(a == [1, 2, 3])
 
+# Sorting is stable, including when reversed, and computes each key once
+def isSorted(a):
+    for i in range(1, len(a)):
+        if a[i] < a[i - 1]:
+            return False
+    return True
+
+a = [(i * 7919) % 1000 for i in range(1000)]
+a.sort()
+assert isSorted(a) and a[0] == 0 and a[999] == 999
+a = [(i * 7919) % 1000 * 0.5 for i in range(1000)]
+a.sort(reverse = True)
+assert a[0] == 499.5 and a[999] == 0.0
+a = list(range(500)) + list(range(500, 0, -1)) + [i % 10 for i in range(100)]
+a.sort()
+assert isSorted(a) and len(a) == 1100
+a = [1, 2.5, 0, -1.5, 2]
+a.sort()
+assert a == [-1.5, 0, 1, 2, 2.5]
+a = ['pear', 'apple', 'fig', 'banana']
+a.sort()
+assert a == ['apple', 'banana', 'fig', 'pear']
+a.sort(key = len)
+assert a == ['fig', 'pear', 'apple', 'banana']
+a.sort(key = len, reverse = True)
+assert a == ['banana', 'apple', 'pear', 'fig']
+
+calls = []
+def key(x):
+    calls.append(x)
+    return x[0]
+a = [(i % 3, i) for i in range(100)]
+a.sort(key = key)
+assert len(calls) == 100
+assert a[0] == (0, 0) and a[1] == (0, 3) and a[33] == (0, 99) and a[34] == (1, 1)
+a.sort(key = key, reverse = True)
+assert a[0] == (2, 2) and a[1] == (2, 5) and a[99] == (0, 99)
+
+class Item:
+    def __init__(self, v):
+        self.v = v
+    def __lt__(self, other):
+        return self.v < other.v
+a = [Item(3), Item(1), Item(2)]
+a.sort()
+assert [x.v for x in a] == [1, 2, 3]
+a = [Item(2), Item(1), Item(2)]
+b = sorted(a)
+assert b[0] is a[1] and b[1] is a[0] and b[2] is a[2]
+
+a = [3, 'x', 1]
+try:
+    a.sort()
+    assert False
+except TypeError:
+    pass
+assert len(a) == 3
+try:
+    a.sort(key = lambda x: x.missing)
+    assert False
+except AttributeError:
+    pass
+a = [3, 1, 2]
+def clear(x):
+    a.append(0)
+    return x
+try:
+    a.sort(key = clear)
+    assert False
+except ValueError:
+    pass
+
 assert [] + [] == []
 assert [1] + [] == [1]
 assert [] + [2] == [2]
@@ -74,4 +146,116 @@ for x, y in enumerate(['a', 'b']):
     r.append(y)
 assert r == [0, 'a', 1, 'b']
 
+# Subscripts with different container types at the same site
+class Squares:
+    def __init__(self):
+        self.stored = {}
+    def __getitem__(self, i):
+        return i * i
+    def __setitem__(self, i, v):
+        self.stored[i] = v
+        return 'ignored'
+
+def getFirst(c):
+    return c[0]
+
+def setFirst(c, v):
+    c[0] = v
+    return c
+
+for i in range(2):
+    assert getFirst([1, 2]) == 1
+    assert getFirst((3, 4)) == 3
+    assert getFirst('ab') == 'a'
+    assert getFirst({0: 'x'}) == 'x'
+    assert getFirst(Squares()) == 0
+    assert setFirst([1, 2], 5) == [5, 2]
+    assert setFirst({}, 5) == {0: 5}
+    assert setFirst(Squares(), 5).stored == {0: 5}
+
+def getLast(c):
+    return c[-1]
+
+for c in ([1, 2], (1, 2), 'ab'):
+    for i in range(2):
+        assert getLast(c) == c[1]
+
+def raises(thunk, exceptionType):
+    try:
+        thunk()
+    except exceptionType:
+        return True
+    return False
+
+for i in range(2):
+    assert raises(lambda: getFirst([]), IndexError)
+    assert raises(lambda: getFirst(()), IndexError)
+    assert raises(lambda: getFirst(''), IndexError)
+    assert raises(lambda: getFirst({}), KeyError)
+    assert raises(lambda: setFirst([], 1), IndexError)
+    assert raises(lambda: getFirst(1), Exception)
+    assert raises(lambda: setFirst((1,), 1), Exception)
+
+# Assignment leaves the value for chained and augmented assignment
+a = [0, 0]
+b = {}
+a[0] = b['x'] = 2
+assert a == [2, 0] and b == {'x': 2}
+a[1] += 3
+b['x'] *= 4
+assert a == [2, 3] and b == {'x': 8}
+a[0], b['y'] = 'p', 'q'
+assert a == ['p', 3] and b == {'x': 8, 'y': 'q'}
+
+# Lists of ints and floats are stored unboxed until another kind is stored
+a = [1, 2, 3]
+a.append(4)
+a[0] = 0
+assert a == [0, 2, 3, 4]
+a[1] = 2.5
+assert a == [0, 2.5, 3, 4]
+assert type(a[0]) == int and type(a[1]) == float
+a.append('x')
+assert a == [0, 2.5, 3, 4, 'x']
+a = [0.5] * 3
+a[2] = 1.5
+assert a == [0.5, 0.5, 1.5]
+a[0] = 1
+assert a == [1, 0.5, 1.5] and type(a[0]) == int
+a = [1, 2, 3, 4]
+del a[1]
+assert a == [1, 3, 4]
+a[1:2] = [1.5, 2.5]
+assert a == [1, 1.5, 2.5, 4]
+a[:] = [0.5]
+assert a == [0.5]
+del a[0]
+a.append(None)
+assert a == [None]
+a = []
+for i in range(100):
+    a.append(i * 0.5)
+assert len(a) == 100 and a[99] == 49.5 and sum(a) == 2475.0
+a[50:] = a
+assert len(a) == 150 and a[50] == 0.0 and a[149] == 49.5
+a = list(range(5))
+b = list(a)
+b[0] = 'x'
+assert a == [0, 1, 2, 3, 4] and b == ['x', 1, 2, 3, 4]
+a = [3, 1, 2]
+a.sort()
+assert a == [1, 2, 3]
+a = [1, 2, 3, 4, 5]
+b = a[4::-2]
+assert b == [5, 3, 1]
+b[0] = 'x'
+assert a[4] == 5 and b == ['x', 3, 1]
+a[1:3] = ['y']
+assert a == [1, 'y', 4, 5]
+a[1:2] = [2.5, 3.5]
+assert a == [1, 2.5, 3.5, 4, 5]
+a = [1.5, 2.5]
+a[1:] = [1]
+assert a == [1.5, 1]
+
 print('ok')
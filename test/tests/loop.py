@@ -164,6 +164,25 @@ assert count == 3
 assert total == 6
 assert last == 3
 
+# Loops over builtin iterators, run more than once to exercise stubs
+def loopTotal(iterable):
+    total = 0
+    for x in iterable:
+        total += x
+    return total
+
+for i in range(3):
+    assert loopTotal([1, 2, 3]) == 6
+    assert loopTotal((1, 2, 3)) == 6
+    assert loopTotal(range(4)) == 6
+    assert loopTotal(OwnSequence([1, 2, 3])) == 6
+
+l = [1, 2]
+count = 0
+for x in l:
+    if x < 4:
+        l.append(x + 2)
+    count += 1
+assert count == 5
 
 print('ok')
-
@@ -0,0 +1,146 @@
+# output: ok
+
+def collect(r):
+    result = []
+    for i in r:
+        result.append(i)
+    return result
+
+assert collect(range(0)) == []
+assert collect(range(3)) == [0, 1, 2]
+assert collect(range(2, 5)) == [2, 3, 4]
+assert collect(range(0, 10, 3)) == [0, 3, 6, 9]
+assert collect(range(5, 0, -2)) == [5, 3, 1]
+assert collect(range(5, 5)) == []
+assert collect(range(5, 0)) == []
+assert collect(range(0, 5, -1)) == []
+assert list(range(-3, 3)) == [-3, -2, -1, 0, 1, 2]
+
+r = range(1, 10, 2)
+assert len(r) == 5
+assert r[0] == 1
+assert r[4] == 9
+assert r[-1] == 9
+assert 3 in r
+assert 4 not in r
+assert 11 not in r
+assert len(range(10, 0, -3)) == 4
+assert len(range(0)) == 0
+assert collect(r) == collect(r)
+
+# Lengths that don't fit in 32 bits
+r = range(-2147483648, 2147483647)
+assert len(r) == 4294967295
+assert r[0] == -2147483648
+assert r[-1] == 2147483646
+assert r[2147483647] == -1
+assert 2147483646 in r
+r = range(2147483647, -2147483648, -1)
+assert len(r) == 4294967295
+assert r[-1] == -2147483647
+assert len(range(-2147483648, 2147483647, 2147483647)) == 3
+
+def raises(thunk, exception):
+    try:
+        thunk()
+    except exception:
+        return True
+    return False
+
+assert raises(lambda: range(1, 2, 0), ValueError)
+assert raises(lambda: range(1.5), TypeError)
+assert raises(lambda: range(3)[3], IndexError)
+assert raises(lambda: range(3)[-4], IndexError)
+
+# Membership works for other numbers equal to an element
+assert 2.0 in range(5)
+assert 2.5 not in range(5)
+assert 4.0 not in range(0, 10, 3)
+assert True in range(2) and False not in range(1, 2)
+assert 'a' not in range(5)
+assert None not in range(5)
+
+# Bounds outside 32 bits
+big = 2 ** 40
+assert collect(range(big, big + 2)) == [big, big + 1]
+assert len(range(2 ** 31 - 5, 2 ** 31 + 5)) == 10
+expected = [2147483646, 2147483647, 2147483648, 2147483649]
+assert collect(range(2 ** 31 - 2, 2 ** 31 + 2)) == expected
+r = range(-big, big, big // 2)
+assert len(r) == 4 and r[1] == -big // 2 and r[-1] == big // 2
+assert r[3] == big // 2 and raises(lambda: r[4], IndexError)
+assert 0 in r and big not in r and -big in r and 1 not in r
+assert float(big // 2) in r
+r = range(big * big, 0, -big)
+assert len(r) == big and r[big - 1] == big and r[-big] == big * big
+assert r[big * 2 // 3] == big * big - (big * 2 // 3) * big
+total = 0
+for i in range(big, big + 4):
+    total += i
+assert total == 4 * big + 6
+a, b = range(big, big + 2)
+assert (a, b) == (big, big + 1)
+assert sum(range(big, big + 3)) == 3 * big + 3
+assert str(range(big)) == 'range(0, ' + str(big) + ')'
+assert len(range(True, 5)) == 4
+
+# Counting loops
+total = 0
+for i in range(10):
+    total += i
+assert total == 45
+assert i == 9
+
+total = 0
+for i in range(10, 0, -1):
+    if i == 8:
+        continue
+    if i == 3:
+        break
+    total += i
+assert total == 10 + 9 + 7 + 6 + 5 + 4
+
+didElse = False
+for i in range(3):
+    pass
+else:
+    didElse = True
+assert didElse
+
+didElse = False
+for i in range(3):
+    if i == 1:
+        break
+else:
+    didElse = True
+assert not didElse
+
+count = 0
+for i in range(4):
+    for j in range(i):
+        count += 1
+assert count == 6
+
+n = 3
+assert [x * x for x in range(n)] == [0, 1, 4]
+
+def gen(n):
+    for i in range(n):
+        yield i
+assert list(gen(4)) == [0, 1, 2, 3]
+
+for i in range(2147483645, 2147483647):
+    last = i
+assert last == 2147483646
+
+# Loops over a shadowed range use the normal iteration protocol
+def shadowed():
+    def range(n):
+        return [n, n]
+    result = []
+    for i in range(5):
+        result.append(i)
+    return result
+assert shadowed() == [5, 5]
+
+print('ok')
@@ -21,4 +21,154 @@ assert(len({1, 2, 3}) == 3)
 assert(a == {3, 2, 1})
 assert(set() != {1})
 
+total = 0
+for x in {1, 2, 3}:
+    total += x
+assert(total == 6)
+
+# Construction from iterables removes duplicates
+assert set([1, 2, 2, 3]) == {1, 2, 3}
+assert set((1, 1)) == {1}
+assert set('abca') == {'a', 'b', 'c'}
+assert set(range(3)) == {0, 1, 2}
+assert set({1, 2}) == {1, 2}
+assert len(set()) == 0
+
+# Equality
+assert {1, 2} == {2, 1}
+assert not ({1, 2} != {2, 1})
+assert {1, 2} != {1, 3}
+assert {1} != {1, 2}
+assert {1} != [1]
+assert not ({1} == (1,))
+
+# Set algebra
+a = {1, 2, 3, 4}
+b = {3, 4, 5}
+assert a | b == {1, 2, 3, 4, 5}
+assert b | a == {1, 2, 3, 4, 5}
+assert a & b == {3, 4}
+assert b & a == {3, 4}
+assert a - b == {1, 2}
+assert b - a == {5}
+assert a - set() == a
+assert set() - a == set()
+assert a.union(b) == {1, 2, 3, 4, 5}
+assert a.union([6]) == {1, 2, 3, 4, 6}
+assert a.intersection(range(3)) == {1, 2}
+assert a.difference((1, 3)) == {2, 4}
+assert a == {1, 2, 3, 4} and b == {3, 4, 5}
+
+# Results are new sets
+c = a | set()
+assert c == a and c is not a
+
+# Subsets
+assert {1, 2} <= a
+assert a <= a
+assert not (a <= b)
+assert a >= {1, 2}
+assert set().issubset(a)
+assert {1, 2}.issubset([1, 2, 3])
+assert not {1, 9}.issubset(a)
+assert a.issuperset((1, 4))
+assert not b.issuperset(a)
+
+# In-place operations
+c = {1, 2}
+d = c
+c |= {2, 3}
+assert c is d and c == {1, 2, 3}
+c &= {2, 3, 4, 5}
+assert c is d and c == {2, 3}
+c -= {3, 4}
+assert c is d and c == {2}
+c.update([5, 6])
+assert c == {2, 5, 6}
+c.intersection_update(range(6))
+assert c == {2, 5}
+c.difference_update([5])
+assert c == {2}
+c -= c
+assert c == set()
+
+# Smaller operand on either side of in-place operations
+c = set(range(10))
+c &= {3, 4}
+assert c == {3, 4}
+c = {3, 4}
+c &= set(range(10))
+assert c == {3, 4}
+c = set(range(10))
+c -= set(range(2, 20))
+assert c == {0, 1}
+
+# Removal
+c = {1, 2, 3}
+c.discard(2)
+c.discard(4)
+assert c == {1, 3}
+c.remove(1)
+assert c == {3}
+threw = False
+try:
+    c.remove(1)
+except KeyError:
+    threw = True
+assert threw
+
+# Adding or removing elements during iteration raises RuntimeError
+def raisesDuringIteration(s, mutate):
+    try:
+        for x in s:
+            mutate(s, x)
+    except RuntimeError:
+        return True
+    return False
+
+assert raisesDuringIteration({1, 2}, lambda s, x: s.add(x + 10))
+assert raisesDuringIteration({1, 2}, lambda s, x: s.remove(x))
+assert not raisesDuringIteration({1, 2}, lambda s, x: s.add(x))
+
+# Mutating methods return None
+c = set()
+assert c.add(1) is None
+assert c.discard(7) is None
+assert c.discard(1) is None
+c.add(2)
+assert c.remove(2) is None
+assert c.update([1, 2, 3]) is None
+assert c.intersection_update([1, 2]) is None
+assert c.difference_update([2]) is None
+assert c == {1}
+
+# Operators only accept sets
+threw = False
+try:
+    {1} | [2]
+except TypeError:
+    threw = True
+assert threw
+
+# Mixed element types
+c = {1, 'a', None}
+assert 1 in c and 'a' in c and None in c
+assert 'b' not in c and 2 not in c
+assert c & {None, 'a', 'x'} == {None, 'a'}
+
+# User defined hashing and equality
+class Key:
+    def __init__(self, x):
+        self.x = x
+    def __hash__(self):
+        return self.x % 3
+    def __eq__(self, other):
+        return isinstance(other, Key) and self.x == other.x
+
+keys = set([Key(i) for i in range(10)] + [Key(i) for i in range(5)])
+assert len(keys) == 10
+assert Key(4) in keys and Key(10) not in keys
+assert len(keys & set([Key(1), Key(20)])) == 1
+assert len(keys - set([Key(i) for i in range(8)])) == 2
+
 print('ok')
@@ -85,6 +85,14 @@ assert data[1::] == [1, 2]
 assert data[:2:] == [0, 1]
 assert data[::2] == [0, 2]
 
+assert data[3:] == []
+assert data[5:] == []
+assert data[-10:] == [0, 1, 2]
+assert data[2:-10:-1] == [2, 1, 0]
+assert data[10::-1] == [2, 1, 0]
+assert data[-10::-1] == []
+assert [0][1:] == []
+
 data2 = Listy([1, 2, 3])
 assert data2[0:2] == [1, 2]
 assert data2[1:-1] == [2]
@@ -10,4 +10,78 @@ def rrr(a = 1, b = 2, c = 3):
 
 assert rrr() == 5
 
+# Check arguments passed to a nested call from native code have space reserved
+
+class Linked:
+    def __init__(self, n, k = 0):
+        self.next = Linked(n - 1, k = 1) if n else None
+
+l = Linked(600)
+count = 0
+while l:
+    count += 1
+    l = l.next
+assert count == 601
+
+# Deep recursion
+
+import sys
+
+def depth(n):
+    return depth(n - 1) + 1 if n else 0
+
+assert depth(1000) == 1000
+
+def recursesForever(n):
+    return recursesForever(n + 1)
+
+def recursesWithKeywords(n = 0):
+    return recursesWithKeywords(n = n + 1)
+
+def recursesWithUnpacked(*args):
+    return recursesWithUnpacked(*args)
+
+class RecursesInInit:
+    def __init__(self, k = 0):
+        RecursesInInit(k = k)
+
+def raisesRecursionError(f, *args):
+    try:
+        f(*args)
+    except RecursionError:
+        return True
+    return False
+
+assert raisesRecursionError(recursesForever, 0)
+assert raisesRecursionError(recursesWithKeywords)
+assert raisesRecursionError(recursesWithUnpacked, 1)
+assert raisesRecursionError(RecursesInInit)
+
+# A function with several locals and temporaries reaches the limit
+def recursesWithLocals(n, a = 1, b = 2):
+    c = a + b
+    d = [a, b, c]
+    return 0 if n == 0 else c - 2 + recursesWithLocals(n - 1, b, a) + len(d) - 3
+
+assert sys.getrecursionlimit() >= 3000
+assert recursesWithLocals(2500) == 2500
+assert raisesRecursionError(recursesWithLocals, 10000)
+
+# The stack is usable again after unwinding
+assert depth(1000) == 1000
+
+limit = sys.getrecursionlimit()
+sys.setrecursionlimit(50)
+assert sys.getrecursionlimit() == 50
+assert raisesRecursionError(depth, 100)
+sys.setrecursionlimit(limit)
+assert depth(100) == 100
+
+threw = False
+try:
+    sys.setrecursionlimit(0)
+except ValueError:
+    threw = True
+assert threw
+
 print("ok")
@@ -91,12 +91,185 @@ assert("foo ".split() == ["foo"])
 assert("    ".split() == [])
 assert("".split() == [])
 
+assert("a,b,,c".split(",") == ["a", "b", "", "c"])
+assert("a b c".split(None, 1) == ["a", "b c"])
+assert(" a  b c ".split(None, 1) == ["a", "b c "])
+assert("a,b,c".split(",", 1) == ["a", "b,c"])
+assert("abc".split(",", 0) == ["abc"])
+assert(" \t\n ".split() == [])
+
+exception = False
+try:
+    "abc".split("")
+except ValueError:
+    exception = True
+assert exception
+
+# searching
+
+assert("abcabc".find("c") == 2)
+assert("abcabc".find("ca") == 2)
+assert("abcabc".find("d") == -1)
+assert("abcabc".find("") == 0)
+assert("abcabc".find("b", 2) == 4)
+assert("abcabc".find("b", -2) == 4)
+assert("abcabc".find("b", 2, 4) == -1)
+assert("abc".find("", 3) == 3)
+assert("abc".find("", 4) == -1)
+assert("abcabc".index("ca") == 2)
+long = ""
+for i in range(10):
+    long += "abcdefghijklmnop"
+assert((long + "needle").find("needle") == 160)
+assert((long + "needle" + long).find("needle") == 160)
+assert(long.find("ponm") == -1)
+assert(long.find("pa") == 15)
+
+exception = False
+try:
+    "abc".index("d")
+except ValueError:
+    exception = True
+assert exception
+
+exception = False
+try:
+    1 in "abc"
+except TypeError:
+    exception = True
+assert exception
+
+assert("abcabc".count("bc") == 2)
+assert("aaaa".count("aa") == 2)
+assert("abc".count("") == 4)
+assert("abcabc".count("a", 1) == 1)
+assert("abcabc".count("a", 1, 3) == 0)
+assert(long.count("a") == 10)
+
+assert("abcabc".startswith("ab"))
+assert(not "abcabc".startswith("bc"))
+assert("abcabc".startswith("bc", 1))
+assert("abcabc".startswith(("x", "a")))
+assert("abcabc".endswith("bc"))
+assert(not "abcabc".endswith("ab"))
+assert("abcabc".endswith("ab", 0, 5))
+assert("abc".endswith(""))
+
+# transforming
+
+assert("abcabc".replace("b", "xx") == "axxcaxxc")
+assert("abcabc".replace("bc", "") == "aa")
+assert("abcabc".replace("b", "x", 1) == "axcabc")
+assert("abc".replace("d", "x") == "abc")
+assert("ab".replace("", "-") == "-a-b-")
+assert(long.replace("a", "").find("a") == -1)
+
+assert("  abc \n".strip() == "abc")
+assert("  abc ".lstrip() == "abc ")
+assert("  abc ".rstrip() == "  abc")
+assert("xxabcxy".strip("xy") == "abc")
+assert("   ".strip() == "")
+assert("abc".strip() == "abc")
+
+assert("aBc1".upper() == "ABC1")
+assert("aBc1".lower() == "abc1")
+assert("".upper() == "")
+
 # join
 
 assert("".join(()) == "")
 assert("".join(["a", "b", "c"]) == "abc")
 assert("_".join(["a", "b", "c"]) == "a_b_c")
 assert("_".join(["", "b", ""]) == "_b_")
+assert(", ".join(("a", "b")) == "a, b")
+assert("-".join(map(str, range(3))) == "0-1-2")
+assert("".join(["abc"]) == "abc")
+
+exception = False
+try:
+    "".join(["a", 1])
+except TypeError:
+    exception = True
+assert exception
+
+# appending
+
+s = ""
+for i in range(100):
+    s += "abcdefgh"
+assert len(s) == 800
+assert s[0] == "a" and s[799] == "h"
+t = s
+s += "1"
+t += "2"
+assert len(s) == 801 and len(t) == 801
+assert s[800] == "1" and t[800] == "2"
+assert s != t
+u = t
+t += "3"
+assert len(u) == 801 and u[800] == "2"
+assert t[801] == "3"
+s = "x"
+s += ""
+assert s == "x"
+
+# slicing
+
+assert("abcdef"[1:3] == "bc")
+assert("abcdef"[::2] == "ace")
+assert("abcdef"[::-1] == "fedcba")
+assert("abcdef"[4:2] == "")
+big = ""
+for i in range(100):
+    big += str(i % 10)
+assert(len(big) == 100)
+assert(big[10:90] == big[0:80])
+assert(big[10:90][5:75] == big[15:85])
+assert(big[10:90][70:] == "0123456789")
+assert(big[:80] + "x" == big[:80] + "x")
+t = big[0:80]
+t += "x"
+assert(len(t) == 81 and t[80] == "x" and big[80] == "0")
+assert(big[10:90].__hash__() == big[20:100].__hash__())
+d = {big[10:90]: 1}
+assert(d[big[0:80]] == 1)
+rest = big
+count = 0
+while len(rest):
+    assert(rest[0] == str(count % 10))
+    rest = rest[1:]
+    count += 1
+assert(count == 100)
+assert(("  " + big + "  ").strip() == big)
+assert(big.split("9") == ["012345678"] * 10 + [""])
+
+# hashing
+
+a = "abc" + str(1)
+b = "ab" + "c1"
+assert a is not b
+assert a.__hash__() == b.__hash__()
+assert a.__hash__() == a.__hash__()
+assert "".__hash__() == "".__hash__()
+d = {a: 1}
+assert d[b] == 1
+assert d["abc1"] == 1
+assert "abc2" not in d
+
+# comparison and concatenation
+
+assert "ab" < "abc"
+assert "abc" > "ab"
+assert "ab" <= "ab"
+assert not ("abd" < "abc")
+assert "" < "a"
+assert "" + "" == ""
+assert "a" + "" == "a"
+assert "" + "a" == "a"
+assert len("ab" + "cd") == 4
+assert "bc" in "abcd"
+assert "" in "abc"
+assert "abcd" not in "abc"
 
 # multiline strings
 